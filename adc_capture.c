@@ -0,0 +1,165 @@
+/**
+ * RP2040 implementation of adc_capture.h
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#include "adc_capture.h"
+
+// DMA channels (VGA driver uses 0 and 1)
+#define capture_chan_0  2
+#define capture_chan_1  3
+
+// ADC clock rate (unmutable!)
+#define ADCCLK 48000000.0
+
+// Two blocks back to back (ping-pong)
+static uint16_t capture_array[2][ADC_CAPTURE_WORDS] ;
+
+// Completed blocks, and the index of the newest one (sequence & 1)
+static volatile uint32_t sequence ;
+static volatile uint32_t overruns ;
+
+// The block DMA_IRQ_1 acknowledges next (its handler keeps no sequence)
+static int irq1_next ;
+
+// Mid-scale code, read before the first block completes
+#define ADC_MID_SCALE 2048
+
+static inline int capture_chan(int index) {
+    return index ? capture_chan_1 : capture_chan_0 ;
+}
+
+void adc_capture_init(void) {
+    // Initialize the ADC hardware
+    adc_init();
+
+    // Make sure GPIO is high-impedance, no pullups etc
+    adc_gpio_init(ADC_PIN_26);
+    adc_gpio_init(ADC_PIN_27);
+    adc_gpio_init(ADC_PIN_28);
+
+    // Convert channels 0, 1, 2, 0, 1, 2, ... starting from channel 0
+    adc_select_input(ADC_CHAN_0) ;
+    adc_set_round_robin((1u << ADC_CHAN_0) | (1u << ADC_CHAN_1) | (1u << ADC_CHAN_2)) ;
+
+    // Setup the FIFO
+    adc_fifo_setup(
+        true,    // Write each completed conversion to the sample FIFO
+        true,    // Enable DMA data request (DREQ)
+        1,       // DREQ (and IRQ) asserted when at least 1 sample present
+        false,   // No ERR bit, keep the samples 12-bit clean
+        false    // Full 12-bit samples
+    );
+
+    // One conversion every 48MHz/(3*Fs) cycles, so each channel is
+    // sampled at the audio sample rate
+    adc_set_clkdiv(ADCCLK / (AUDIO_IN_CHANNELS * AUDIO_SAMPLE_RATE) - 1) ;
+
+    for (int index = 0; index < 2; index++) {
+        dma_channel_config c = dma_channel_get_default_config(capture_chan(index)) ;
+
+        // Reading from constant address, writing to incrementing halfwords
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16) ;
+        channel_config_set_read_increment(&c, false) ;
+        channel_config_set_write_increment(&c, true) ;
+        // Pace transfers based on availability of ADC samples
+        channel_config_set_dreq(&c, DREQ_ADC) ;
+        // When this block is full, start filling the other. The chain
+        // costs no conversions, so the channel order never slips.
+        channel_config_set_chain_to(&c, capture_chan(!index)) ;
+
+        dma_channel_configure(capture_chan(index),
+            &c,                     // channel config
+            capture_array[index],   // dst
+            &adc_hw->fifo,          // src
+            ADC_CAPTURE_WORDS,      // transfer count
+            false                   // don't start immediately
+        ) ;
+    }
+}
+
+void adc_capture_set_irq_enabled(unsigned int irq_index, bool enabled) {
+    if (irq_index == 0) {
+        dma_channel_set_irq0_enabled(capture_chan_0, enabled) ;
+        dma_channel_set_irq0_enabled(capture_chan_1, enabled) ;
+    }
+    else {
+        dma_channel_set_irq1_enabled(capture_chan_0, enabled) ;
+        dma_channel_set_irq1_enabled(capture_chan_1, enabled) ;
+    }
+}
+
+int __not_in_flash_func(adc_capture_acknowledge_irq0)(void) {
+    uint32_t pending = dma_hw->ints0 & ((1u << capture_chan_0) | (1u << capture_chan_1)) ;
+    if (!pending) return -1 ;
+
+    // Both blocks done: the older one was never handled in time
+    if (pending == ((1u << capture_chan_0) | (1u << capture_chan_1))) overruns++ ;
+
+    // Blocks complete in sequence order, so handle the one after the
+    // last acknowledged first
+    int index = sequence & 1 ;
+    if (!(pending & (1u << capture_chan(index)))) index = !index ;
+    dma_hw->ints0 = 1u << capture_chan(index) ;
+
+    // Rewind this block's channel; it is triggered again by the chain
+    // from the other block one block period from now
+    dma_channel_set_write_addr(capture_chan(index), capture_array[index], false) ;
+    sequence++ ;
+    return index ;
+}
+
+int __not_in_flash_func(adc_capture_acknowledge_irq1)(void) {
+    uint32_t pending = dma_hw->ints1 & ((1u << capture_chan_0) | (1u << capture_chan_1)) ;
+    if (!pending) return -1 ;
+
+    // In sequence order, as for DMA_IRQ_0
+    int index = irq1_next ;
+    if (!(pending & (1u << capture_chan(index)))) index = !index ;
+    dma_hw->ints1 = 1u << capture_chan(index) ;
+    irq1_next = !index ;
+    return index ;
+}
+
+const uint16_t *adc_capture_block(int index) {
+    return capture_array[index] ;
+}
+
+void adc_capture_start(void) {
+    // Start the capture channel, then the free-running ADC
+    adc_fifo_drain() ;
+    dma_channel_start(capture_chan_0) ;
+    adc_run(true) ;
+}
+
+uint16_t adc_capture_read(unsigned int chan) {
+    uint32_t seq, total ;
+
+    // Nothing captured yet: report the centre (a joystick at rest), not
+    // the empty buffer's zeros
+    if (sequence == 0) return ADC_MID_SCALE ;
+
+    // Retry if a new block completed (and its buffer started refilling)
+    // while we were averaging the newest one
+    do {
+        seq = sequence ;
+        const uint16_t *block = capture_array[(seq - 1) & 1] ;
+        total = 0 ;
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            total += block[AUDIO_IN_CHANNELS * i + chan] ;
+        }
+    } while (seq != sequence) ;
+
+    return total / AUDIO_BLOCK_SIZE ;
+}
+
+uint32_t adc_capture_sequence(void) {
+    return sequence ;
+}
+
+uint32_t adc_capture_overruns(void) {
+    return overruns ;
+}
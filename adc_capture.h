@@ -0,0 +1,62 @@
+/**
+ * Single owner of the RP2040 ADC
+ *
+ * Nothing else in the firmware may call adc_select_input() or read the
+ * ADC directly. The ADC free-runs in round-robin over channels 0, 1 and
+ * 2 (one conversion every 1/(3*Fs) seconds), and two chained DMA
+ * channels write the interleaved conversions into two capture blocks in
+ * turn. Frame n of a block holds channels 0, 1, 2 converted back to back,
+ * so every channel is sampled at exactly the audio rate with a fixed
+ * 1/(3*Fs) skew and no mux switching in software.
+ *
+ * Each completed block gets a sequence number. Consumers take the
+ * channel they want out of a block as a contiguous slice
+ * (audio_in_slice() in audio_hal.h) or, from thread context, as the
+ * mean of the newest block (adc_capture_read()).
+ *
+ * RESOURCES USED
+ *  - ADC channels 0-2 (GPIO 26-28), round-robin, FIFO DREQ
+ *  - DMA channels 2 and 3
+ */
+
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_hal.h"
+
+// Conversions in one capture block
+#define ADC_CAPTURE_WORDS (AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS)
+
+// Set up the ADC round-robin and the capture DMA (does not start them)
+void adc_capture_init(void) ;
+
+// Route block completions to DMA_IRQ_0 (irq_index 0) or DMA_IRQ_1 (1)
+void adc_capture_set_irq_enabled(unsigned int irq_index, bool enabled) ;
+
+// Call from the DMA_IRQ_0 handler. Acknowledges one completed block and
+// returns its index (0 or 1), or -1 when nothing is pending. Also
+// rewinds the block's DMA channel and advances the sequence number.
+int adc_capture_acknowledge_irq0(void) ;
+
+// Same for the DMA_IRQ_1 handler (acknowledge only)
+int adc_capture_acknowledge_irq1(void) ;
+
+// Interleaved conversions of capture block 0 or 1
+const uint16_t *adc_capture_block(int index) ;
+
+// Drain the FIFO and start converting, beginning with channel 0
+void adc_capture_start(void) ;
+
+// Mean of one channel over the newest complete block (thread context),
+// or mid-scale (2048) until the first block completes
+uint16_t adc_capture_read(unsigned int chan) ;
+
+// Blocks completed so far, and blocks that completed while the previous
+// one was still unacknowledged (its handler ran late)
+uint32_t adc_capture_sequence(void) ;
+uint32_t adc_capture_overruns(void) ;
+
+#endif
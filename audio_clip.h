@@ -0,0 +1,108 @@
+/**
+ * Flash-resident audio clips
+ *
+ * A clip is a run of 8-bit G.711 mu-law samples at AUDIO_SAMPLE_RATE,
+ * mono, stored in flash by gen_audio_assets.py (audio_assets.h lists
+ * them). Nothing is copied to RAM: an audio_clip_reader walks the bytes
+ * in place through XIP and decodes one block at a time into the
+ * engine's q15 samples, at the cost of a byte load and a table load per
+ * sample.
+ *
+ * With AUDIO_ASSET_FORMAT bin the clips are linked in as one image
+ * (audio_asset_image) that starts with a directory, laid out below, so
+ * an image written to flash on its own can be read the same way.
+ *
+ * Mu-law keeps about 13 bits of dynamic range in 8 bits, more than the
+ * 12-bit DAC can reproduce, and halves the flash of 16-bit PCM.
+ */
+
+#ifndef AUDIO_CLIP_H
+#define AUDIO_CLIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fix15.h"
+
+// One clip in the asset image
+typedef struct {
+    const uint8_t *data ;       // mu-law samples
+    uint32_t frames ;           // number of samples
+} audio_clip ;
+
+// Playback position in one clip
+typedef struct {
+    const audio_clip *clip ;
+    uint32_t pos ;              // next sample
+} audio_clip_reader ;
+
+// Asset image: this header, count directory entries, then the clips
+// (little endian, every clip 4-byte aligned)
+#define AUDIO_ASSET_IMAGE_MAGIC   0x41415053u   // "SPAA"
+#define AUDIO_ASSET_IMAGE_VERSION 1
+
+typedef struct {
+    uint32_t magic ;
+    uint16_t version ;
+    uint16_t count ;            // clips
+    uint32_t rate ;             // sample rate, Hz
+    uint32_t reserved ;
+} audio_asset_image_header ;
+
+typedef struct {
+    uint32_t offset ;           // first sample, from the start of the image
+    uint32_t frames ;
+    char name[24] ;             // NUL-terminated, as in ASSET_<NAME>
+} audio_asset_entry ;
+
+// Point clip at entry index of an image. Returns false if the image is
+// not a valid asset image or index is out of range.
+static inline bool audio_asset_image_clip(const uint8_t *image, unsigned int index, audio_clip *clip) {
+    const audio_asset_image_header *h = (const audio_asset_image_header *)image ;
+    if (h->magic != AUDIO_ASSET_IMAGE_MAGIC || h->version != AUDIO_ASSET_IMAGE_VERSION || index >= h->count) {
+        return false ;
+    }
+    const audio_asset_entry *e = (const audio_asset_entry *)(h + 1) + index ;
+    clip->data = image + e->offset ;
+    clip->frames = e->frames ;
+    return true ;
+}
+
+// G.711 mu-law to 16-bit linear PCM
+extern const int16_t mulaw_decode_table[256] ;
+
+// 16-bit linear PCM is already a q15 sample
+#define mulaw_to_q15(b) ((q15)mulaw_decode_table[b])
+
+static inline void audio_clip_start(audio_clip_reader *r, const audio_clip *clip) {
+    r->clip = clip ;
+    r->pos = 0 ;
+}
+
+// True once a non-looping reader has passed the end of its clip
+static inline bool audio_clip_finished(const audio_clip_reader *r) {
+    return r->pos >= r->clip->frames ;
+}
+
+// Decode the next n samples into out (q15, centred on zero). Past the
+// end the reader wraps to the start if loop is set, otherwise it pads
+// with silence.
+static inline void audio_clip_read(audio_clip_reader *r, q15 *out, int n, bool loop) {
+    const uint8_t *data = r->clip->data ;
+    uint32_t frames = r->clip->frames ;
+    uint32_t pos = r->pos ;
+
+    for (int i = 0; i < n; i++) {
+        if (pos >= frames) {
+            if (!loop) {
+                out[i] = 0 ;
+                continue ;
+            }
+            pos = 0 ;
+        }
+        out[i] = mulaw_to_q15(data[pos++]) ;
+    }
+    r->pos = pos ;
+}
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * Hardware abstraction for the spatial audio engine
+ *
+ * The DSP in spatial_audio.c only talks to the outside world through
+ * the functions below. audio_hal_pico.c implements them on the RP2040;
+ * host/audio_hal_host.c implements them on a PC so the exact same
+ * block code can be run offline.
+ *
+ * Audio moves in blocks of AUDIO_BLOCK_SIZE frames. The ADC free-runs
+ * in round-robin over channels 0, 1 and 2 (adc_capture.h is its only
+ * owner), and DMA fills one capture block while the previous one is
+ * processed. When a block completes,
+ * every attached handler runs (one per core) and writes its words of
+ * the matching output block. A second DMA stream paces those words
+ * out to the DAC at the sample rate, one block behind the input.
+ *
+ * The DAC is chosen at build time (AUDIO_OUTPUT in CMakeLists.txt):
+ *
+ *  - AUDIO_OUT_MCP4822: 12-bit codes to the MCP4822 over SPI (default)
+ *  - AUDIO_OUT_I2S:     16-bit samples to an I2S DAC through pio1
+ *
+ * Handlers build their words with audio_out_word(), so the same block
+ * code serves either one.
+ *
+ * HARDWARE CONNECTIONS (Pico build)
+ *  - GPIO 26 (ADC 0) ---> Left audio source
+ *  - GPIO 27 (ADC 1) ---> Joystick x-axis
+ *  - GPIO 28 (ADC 2) ---> Right audio source
+ *  - GPIO 5/6/7      ---> MCP4822 CS/SCK/SDI
+ *  - GPIO 8          ---> MCP4822 LDAC (pulsed once per frame by pio1)
+ *  - or, with AUDIO_OUT_I2S:
+ *    GPIO 9/10/11      ---> I2S DATA/BCLK/LRCLK
+ *
+ * RESOURCES USED (Pico build)
+ *  - ADC channels 0-2, DMA channels 2 and 3 (adc_capture.c)
+ *  - DMA channels 4 and 5 (DAC playback and its restart channel)
+ *  - DMA pacing timer 0
+ *  - One pio1 state machine, 5 instructions (LDAC latch, ldac.pio),
+ *    or 8 instructions with AUDIO_OUT_I2S (i2s.pio)
+ *  - DMA_IRQ_0 on core 0, DMA_IRQ_1 on core 1
+ *  - SysTick on both cores (block timing, isr_profile.h)
+ */
+
+#ifndef AUDIO_HAL_H
+#define AUDIO_HAL_H
+
+#include <stdint.h>
+
+// Audio sample rate (Hz, set by spatial_audio.cmake) and sample period (us)
+#ifndef AUDIO_SAMPLE_RATE
+#define AUDIO_SAMPLE_RATE 40000
+#endif
+#define AUDIO_SAMPLE_PERIOD_US (1000000 / AUDIO_SAMPLE_RATE)
+
+// Frames per block (0.8 ms at 40 kHz)
+#define AUDIO_BLOCK_SIZE 32
+
+// ADC conversions per input frame: channels 0, 1, 2 in round-robin order
+#define AUDIO_IN_CHANNELS 3
+
+// DAC words per output frame: channel A (left), then channel B (right)
+#define AUDIO_OUT_CHANNELS 2
+
+// ADC Channel and pin
+#define ADC_CHAN_0 0
+#define ADC_CHAN_1 1
+#define ADC_CHAN_2 2
+#define ADC_PIN_28 28
+#define ADC_PIN_26 26
+#define ADC_PIN_27 27
+
+// Output backends
+#define AUDIO_OUT_MCP4822 0
+#define AUDIO_OUT_I2S     1
+
+#ifndef AUDIO_OUT
+#define AUDIO_OUT AUDIO_OUT_MCP4822
+#endif
+
+// DAC parameters (see the DAC datasheet)
+// A-channel, 1x, active
+#define DAC_config_chan_A 0b0011000000000000
+// B-channel, 1x, active
+#define DAC_config_chan_B 0b1011000000000000
+
+// Output word of DAC channel dac (0 = A/left, 1 = B/right) for a q15
+// sample, saturated: config bits | 12-bit code for the MCP4822, the
+// sample itself for I2S
+static inline uint16_t audio_out_word(unsigned int dac, int32_t sample) {
+#if AUDIO_OUT == AUDIO_OUT_I2S
+    (void)dac ;
+    if (sample < -32768) sample = -32768 ;
+    if (sample > 32767) sample = 32767 ;
+    return (uint16_t)sample ;
+#else
+    int32_t code = (sample >> 4) + 2048 ;
+    if (code < 0) code = 0 ;
+    if (code > 4095) code = 4095 ;
+    return (uint16_t)((dac ? DAC_config_chan_B : DAC_config_chan_A) | code) ;
+#endif
+}
+
+// Processes one block. in[AUDIO_IN_CHANNELS*n + chan] is the 12-bit
+// code of ADC channel chan in frame n; the handler fills its own words
+// out[AUDIO_OUT_CHANNELS*n + dac] (audio_out_word()). out is word
+// aligned, so a handler that writes both channels may store a frame as
+// one 32-bit word.
+typedef void (*audio_block_handler_t)(const uint16_t *in, uint16_t *out) ;
+
+// Bring up the ADC and the DAC (call once from core 0)
+void audio_hal_init(void) ;
+
+// Run handler on the calling core for every captured block
+void audio_hal_attach(audio_block_handler_t handler) ;
+
+// Start capture and playback (core 0, after every core has attached)
+void audio_hal_start(void) ;
+
+// 12-bit level of an ADC channel, averaged over the newest block. For
+// thread context (the joystick); never switches the ADC input.
+uint16_t audio_hal_adc_read(unsigned int chan) ;
+
+// Copy one ADC channel of an input block into a contiguous slice
+static inline void audio_in_slice(const uint16_t *in, unsigned int chan, uint16_t *slice) {
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        slice[i] = in[AUDIO_IN_CHANNELS * i + chan] ;
+    }
+}
+
+#endif
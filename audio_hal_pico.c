@@ -0,0 +1,251 @@
+/**
+ * RP2040 implementation of audio_hal.h
+ *
+ * Capture: adc_capture.c owns the ADC and fills two capture blocks in
+ * turn (ping-pong); each completion raises DMA_IRQ_0 (core 0) and
+ * DMA_IRQ_1 (core 1), and each core runs its attached block handler on
+ * the block that just filled.
+ *
+ * Playback: the handlers write into the matching half of
+ * playback_array. One DMA channel streams the whole array to the DAC;
+ * a second channel rewrites its read address and restarts it, the same
+ * way the VGA driver loops over its pixel array. Playback is started
+ * when the second block arrives, so every block has a full block
+ * period to be processed before it is sent.
+ *
+ *  - MCP4822: a DMA timer paces the words at two per sample period into
+ *    the SPI data register. A pio1 state machine (ldac.pio) watches CS
+ *    and pulses LDAC after every channel B word, so both channels of a
+ *    frame latch on the same edge with no CPU involved.
+ *  - I2S (AUDIO_OUT_I2S): the words go to the TX FIFO of a pio1 state
+ *    machine (i2s.pio) that shifts them out at the sample rate; the
+ *    FIFO paces the DMA.
+ *
+ * The ADC clock (48 MHz USB PLL) and the system clock both come from the
+ * crystal, so input and output rates stay locked.
+ *
+ * Every handler call is timed with the calling core's SysTick, run as a
+ * free-running cycle counter, and recorded by isr_profile.h.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "hardware/structs/systick.h"
+
+#include "audio_hal.h"
+#include "adc_capture.h"
+#include "isr_profile.h"
+#if AUDIO_OUT == AUDIO_OUT_I2S
+#include "i2s.pio.h"
+#else
+#include "ldac.pio.h"
+#endif
+
+//SPI configurations (note these represent GPIO number, NOT pin number)
+#define PIN_MISO 4
+#define PIN_CS   5
+#define PIN_SCK  6
+#define PIN_MOSI 7
+#define LDAC     8
+#define SPI_PORT spi0
+
+// I2S (AUDIO_OUT_I2S): LRCLK is the GPIO after BCLK
+#define PIN_I2S_DATA 9
+#define PIN_I2S_BCLK 10
+
+// DMA channels (VGA driver uses 0 and 1, adc_capture.c 2 and 3)
+#define playback_chan   4
+#define restart_chan    5
+#define playback_timer  0
+
+// LDAC latch or I2S output (the VGA driver has all of pio0)
+#define DAC_PIO pio1
+
+// Words in one output block
+#define PLAYBACK_WORDS (AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS)
+
+// Two blocks back to back, matching the two capture blocks
+static uint16_t __attribute__((aligned(4))) playback_array[2][PLAYBACK_WORDS] ;
+
+// Read address for the playback restart channel (POINTER TO AN ADDRESS)
+static uint16_t * playback_address_pointer = &playback_array[0][0] ;
+
+// Block handler attached on each core
+static audio_block_handler_t block_handler[2] ;
+
+static volatile bool playback_running ;
+
+// SysTick: 24-bit down-counter at the system clock, one per core
+#define SYSTICK_MASK 0xffffff
+
+// Start the calling core's SysTick free-running over its full range
+static void profile_clock_init(void) {
+    systick_hw->csr = 0 ;
+    systick_hw->rvr = SYSTICK_MASK ;
+    systick_hw->cvr = 0 ;
+    systick_hw->csr = 0x5 ;     // enable, processor clock, no interrupt
+}
+
+// Cycles, counting up
+static inline uint32_t profile_ticks(void) {
+    return ~systick_hw->cvr & SYSTICK_MASK ;
+}
+
+#if AUDIO_OUT != AUDIO_OUT_I2S
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b ;
+        a = b ;
+        b = t ;
+    }
+    return a ;
+}
+#endif
+
+// Core 0: owns the capture bookkeeping, then runs its handler
+static void __not_in_flash_func(capture_irq_core_0)(void) {
+    int block ;
+    while ((block = adc_capture_acknowledge_irq0()) >= 0) {
+        // Second block in: start sending the first one
+        if (block == 1 && !playback_running) {
+            playback_running = true ;
+            dma_channel_start(playback_chan) ;
+        }
+
+        isr_profile_enter(0, profile_ticks()) ;
+        if (block_handler[0]) block_handler[0](adc_capture_block(block), playback_array[block]) ;
+        isr_profile_exit(0, profile_ticks()) ;
+    }
+}
+
+// Core 1: only runs its handler
+static void __not_in_flash_func(capture_irq_core_1)(void) {
+    int block ;
+    while ((block = adc_capture_acknowledge_irq1()) >= 0) {
+        isr_profile_enter(1, profile_ticks()) ;
+        if (block_handler[1]) block_handler[1](adc_capture_block(block), playback_array[block]) ;
+        isr_profile_exit(1, profile_ticks()) ;
+    }
+}
+
+void audio_hal_init(void) {
+#if AUDIO_OUT == AUDIO_OUT_I2S
+    // I2S state machine: waits on a left slot until playback starts
+    uint i2s_offset = pio_add_program(DAC_PIO, &i2s_program) ;
+    uint i2s_sm = pio_claim_unused_sm(DAC_PIO, true) ;
+    i2s_program_init(DAC_PIO, i2s_sm, i2s_offset, PIN_I2S_DATA, PIN_I2S_BCLK, AUDIO_SAMPLE_RATE) ;
+#else
+    // Initialize SPI channel (channel, baud rate set to 20MHz)
+    spi_init(SPI_PORT, 20000000) ;
+    // Format (channel, data bits per transfer, polarity, phase, order)
+    spi_set_format(SPI_PORT, 16, 0, 0, 0);
+
+    // Map SPI signals to GPIO ports
+    gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);
+    gpio_set_function(PIN_SCK, GPIO_FUNC_SPI);
+    gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
+    gpio_set_function(PIN_CS, GPIO_FUNC_SPI) ;
+
+    // LDAC latch: must start while CS is idle, so it counts A/B words
+    // from the first frame (playback starts with the second block)
+    uint ldac_offset = pio_add_program(DAC_PIO, &ldac_program) ;
+    uint ldac_sm = pio_claim_unused_sm(DAC_PIO, true) ;
+    ldac_program_init(DAC_PIO, ldac_sm, ldac_offset, LDAC, PIN_CS) ;
+#endif
+
+    // The ADC and the capture DMA
+    adc_capture_init() ;
+
+    /////////////////////////////////////////////////////////////////////////////////
+    // ============================== PLAYBACK DMA CONFIGURATION ====================
+    /////////////////////////////////////////////////////////////////////////////////
+    int sys_hz = clock_get_hz(clk_sys) ;
+#if AUDIO_OUT == AUDIO_OUT_I2S
+    // The I2S state machine takes a word whenever its FIFO has room
+    uint playback_dreq = pio_get_dreq(DAC_PIO, i2s_sm, true) ;
+    volatile void *playback_dest = &DAC_PIO->txf[i2s_sm] ;
+#else
+    // Pace the playback channel at AUDIO_OUT_CHANNELS words per sample
+    // period: the DMA timer fires sys_clk * X / Y times per second
+    int words_per_sec = AUDIO_OUT_CHANNELS * AUDIO_SAMPLE_RATE ;
+    int div = gcd(words_per_sec, sys_hz) ;
+    dma_timer_set_fraction(playback_timer, words_per_sec / div, sys_hz / div) ;
+    uint playback_dreq = dma_get_timer_dreq(playback_timer) ;
+    volatile void *playback_dest = &spi_get_hw(SPI_PORT)->dr ;
+#endif
+
+    // One block period of system clock cycles is the handlers' budget
+    isr_profile_init((uint32_t)((uint64_t)sys_hz * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE),
+                     sys_hz / 1000000, SYSTICK_MASK) ;
+
+    // Playback channel (sends both halves of playback_array to the DAC)
+    dma_channel_config c4 = dma_channel_get_default_config(playback_chan) ;
+    channel_config_set_transfer_data_size(&c4, DMA_SIZE_16) ;
+    channel_config_set_read_increment(&c4, true) ;
+    channel_config_set_write_increment(&c4, false) ;
+    channel_config_set_dreq(&c4, playback_dreq) ;
+    channel_config_set_chain_to(&c4, restart_chan) ;
+
+    dma_channel_configure(
+        playback_chan,                  // Channel to be configured
+        &c4,                            // The configuration we just created
+        playback_dest,                  // write address (SPI DR or PIO FIFO)
+        playback_array,                 // The initial read address
+        2 * PLAYBACK_WORDS,             // Both halves, one halfword each
+        false                           // Don't start immediately.
+    ) ;
+
+    // Restart channel (reconfigures and restarts the playback channel)
+    dma_channel_config c5 = dma_channel_get_default_config(restart_chan) ;
+    channel_config_set_transfer_data_size(&c5, DMA_SIZE_32) ;
+    channel_config_set_read_increment(&c5, false) ;
+    channel_config_set_write_increment(&c5, false) ;
+    channel_config_set_chain_to(&c5, playback_chan) ;
+
+    dma_channel_configure(
+        restart_chan,                           // Channel to be configured
+        &c5,                                    // The configuration we just created
+        &dma_hw->ch[playback_chan].read_addr,   // Write address (playback read address)
+        &playback_address_pointer,              // Read address (POINTER TO AN ADDRESS)
+        1,                                      // Number of transfers, each is 4 bytes
+        false                                   // Don't start immediately.
+    ) ;
+
+    // Mid-scale on both channels until the first block is sent
+    for (int half = 0; half < 2; half++) {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            playback_array[half][AUDIO_OUT_CHANNELS * i]     = audio_out_word(0, 0) ;
+            playback_array[half][AUDIO_OUT_CHANNELS * i + 1] = audio_out_word(1, 0) ;
+        }
+    }
+}
+
+void audio_hal_attach(audio_block_handler_t handler) {
+    uint core = get_core_num() ;
+    block_handler[core] = handler ;
+    profile_clock_init() ;
+
+    // Each capture block interrupts both cores, on separate IRQ lines
+    adc_capture_set_irq_enabled(core, true) ;
+    if (core == 0) {
+        irq_set_exclusive_handler(DMA_IRQ_0, capture_irq_core_0) ;
+        irq_set_enabled(DMA_IRQ_0, true) ;
+    }
+    else {
+        irq_set_exclusive_handler(DMA_IRQ_1, capture_irq_core_1) ;
+        irq_set_enabled(DMA_IRQ_1, true) ;
+    }
+}
+
+void audio_hal_start(void) {
+    // Playback follows capture (see capture_irq_core_0)
+    adc_capture_start() ;
+}
+
+uint16_t audio_hal_adc_read(unsigned int chan) {
+    return adc_capture_read(chan) ;
+}
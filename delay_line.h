@@ -0,0 +1,135 @@
+/**
+ * Ring-buffer delay line for the ITD taps
+ *
+ * The history of one input is kept in a power-of-two circular buffer.
+ * Writing a new sample moves the head by one and reading the sample
+ * from n periods ago is a single masked load, so the cost per sample
+ * does not depend on how long the line is. Growing the maximum delay
+ * only means raising DELAY_LINE_LENGTH (keep it a power of two).
+ *
+ * Samples are q15 (fix15.h) and every interpolator keeps its products
+ * in 32 bits. Delays are given in samples as fix15, so an ITD can fall
+ * between two samples (25us steps at 40 kHz are too coarse for smooth
+ * placement).
+ * Three interpolators are provided:
+ *
+ *  - linear:    2 taps, 1 multiply. Cheap, slight high-frequency droop.
+ *  - lagrange3: 4 taps, 3rd-order Lagrange in Farrow form, 5 multiplies.
+ *               Flat to a much higher frequency. Needs a delay >= 1.
+ *  - thiran:    1st-order allpass, 2 multiplies, but it keeps one sample
+ *               of state per reader and rings briefly when the delay
+ *               changes, so it suits fixed rather than moving delays.
+ *
+ * delay_line_tap_frac() picks linear or lagrange3 at build time with
+ * DELAY_LINE_INTERP (1 or 3).
+ */
+
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+#include "fix15.h"
+
+// Must be a power of two; taps 0 .. DELAY_LINE_LENGTH-1 are readable
+#define DELAY_LINE_LENGTH 64
+#define DELAY_LINE_MASK (DELAY_LINE_LENGTH - 1)
+
+typedef struct {
+    q15 buf[DELAY_LINE_LENGTH] ;    // sample history
+    unsigned int head ;             // index of the newest sample
+} delay_line ;
+
+// Append the newest sample, overwriting the oldest one
+static inline void delay_line_push(delay_line *d, q15 x) {
+    d->head = (d->head + 1) & DELAY_LINE_MASK ;
+    d->buf[d->head] = x ;
+}
+
+// Sample from n periods ago (n = 0 is the newest)
+static inline q15 delay_line_tap(const delay_line *d, unsigned int n) {
+    return d->buf[(d->head - n) & DELAY_LINE_MASK] ;
+}
+
+// Interpolation order used by delay_line_tap_frac() (1 = linear, 3 = Lagrange)
+#ifndef DELAY_LINE_INTERP
+#define DELAY_LINE_INTERP 1
+#endif
+
+// Largest fractional delay any interpolator can read without wrapping
+#define DELAY_LINE_MAX_DELAY int2fix15(DELAY_LINE_LENGTH - 3)
+
+// Linear interpolation between the two taps around delay (fix15 samples)
+static inline q15 delay_line_tap_linear(const delay_line *d, fix15 delay) {
+    unsigned int n = delay >> 15 ;
+    int32_t frac = delay & 0x7fff ;
+    int32_t a = delay_line_tap(d, n) ;
+    int32_t b = delay_line_tap(d, n + 1) ;
+    // |b - a| < 2^16 and frac < 2^15: the product fits
+    return (q15)(a + (((b - a) * frac) >> 15)) ;
+}
+
+// 4-point, 3rd-order Lagrange interpolation (Farrow structure) around
+// delay. Uses taps n-1 .. n+2, so delays below one sample fall back to
+// linear interpolation instead of reading a sample that isn't there yet.
+// The polynomial can overshoot full scale, so the result is saturated.
+static inline q15 delay_line_tap_lagrange3(const delay_line *d, fix15 delay) {
+    unsigned int n = delay >> 15 ;
+    int32_t frac = delay & 0x7fff ;
+    if (n == 0) return delay_line_tap_linear(d, delay) ;
+
+    int32_t ym1 = delay_line_tap(d, n - 1) ;
+    int32_t y0  = delay_line_tap(d, n) ;
+    int32_t y1  = delay_line_tap(d, n + 1) ;
+    int32_t y2  = delay_line_tap(d, n + 2) ;
+
+    // Polynomial coefficients (1/3 and 1/6 as Q15 constants)
+    int32_t c1 = y1 - mulq15(ym1, 10923) - (y0 >> 1) - mulq15(y2, 5461) ;
+    int32_t c2 = ((ym1 + y1) >> 1) - y0 ;
+    int32_t c3 = mulq15(y2 - ym1, 5461) + ((y0 - y1) >> 1) ;
+
+    // Horner steps with the running sum shifted down by 2, so each
+    // product stays under 2^31 (|c1|, |c2| < 2^17, |c3| < 2^16)
+    int32_t p = c3 >> 2 ;
+    p = ((c2 >> 2) + ((frac * p) >> 15)) ;
+    p = ((c1 >> 2) + ((frac * p) >> 15)) ;
+    return satq15(y0 + ((frac * p) >> 13)) ;
+}
+
+// Build-time choice of interpolator for the ITD taps
+static inline q15 delay_line_tap_frac(const delay_line *d, fix15 delay) {
+#if DELAY_LINE_INTERP == 3
+    return delay_line_tap_lagrange3(d, delay) ;
+#else
+    return delay_line_tap_linear(d, delay) ;
+#endif
+}
+
+// First-order Thiran allpass reader. The integer part of the delay is
+// read from the line; the allpass supplies the fraction, which is kept
+// in [0.5, 1.5) where the filter's group delay is most accurate.
+typedef struct {
+    unsigned int n ;    // integer tap feeding the allpass
+    fix15 eta ;         // allpass coefficient (1-d)/(1+d), |eta| <= 1/3
+    int32_t x1 ;        // previous input
+    int32_t y1 ;        // previous output
+} delay_thiran ;
+
+// Set a new delay (fix15 samples, >= 0.5). Call outside the sample loop,
+// it divides.
+static inline void delay_thiran_set(delay_thiran *t, fix15 delay) {
+    fix15 half = int2fix15(1) >> 1 ;
+    if (delay < half) delay = half ;
+    t->n = (delay - half) >> 15 ;
+    fix15 frac = delay - int2fix15(t->n) ;
+    t->eta = divfix(int2fix15(1) - frac, int2fix15(1) + frac) ;
+}
+
+// Read one sample; call exactly once per pushed sample
+static inline q15 delay_thiran_tap(delay_thiran *t, const delay_line *d) {
+    int32_t x = delay_line_tap(d, t->n) ;
+    int32_t y = mulq15(t->eta, x - t->y1) + t->x1 ;
+    t->x1 = x ;
+    t->y1 = y ;
+    return satq15(y) ;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * Fixed-point helpers shared by the audio code
+ *
+ * fix15 is a signed 32-bit number with 15 fractional bits, so 1.0 is
+ * 32768. The RP2040 has no FPU, and these turn every audio multiply
+ * into an integer multiply and a shift.
+ *
+ * Audio samples are q15: Q1.15 in 16 bits, full scale being the full
+ * range of the 12-bit converters. A q15 sample times a fix15 gain of at
+ * most 1.0 fits in 32 bits, so mulq15 is a single MULS on the M0+,
+ * where multfix15 needs a 64-bit multiply call (__aeabi_lmul). Keep
+ * multfix15 for control values that can exceed 1.0.
+ */
+
+#ifndef FIX15_H
+#define FIX15_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Macros for fixed-point arithmetic (faster than floating point)
+typedef signed int fix15 ;
+#define multfix15(a,b) ((fix15)((((signed long long)(a))*((signed long long)(b)))>>15))
+#define float2fix15(a) ((fix15)((a)*32768.0))
+#define fix2float15(a) ((float)(a)/32768.0)
+#define absfix15(a) abs(a)
+#define int2fix15(a) ((fix15)((a) << 15))
+#define fix2int15(a) ((int)((a) >> 15))
+#define char2fix15(a) (fix15)(((fix15)(a)) << 15)
+#define divfix(a,b) (fix15)( (((signed long long)(a)) << 15) / (b))
+
+// Q1.15 samples, and their product with a gain in [-1.0, 1.0] (32-bit)
+typedef int16_t q15 ;
+#define mulq15(a,b) ((int32_t)((int32_t)(a) * (int32_t)(b)) >> 15)
+
+// Clamp a 32-bit intermediate back into a q15 sample
+static inline q15 satq15(int32_t x) {
+    return (x > 32767) ? 32767 : (x < -32768) ? -32768 : (q15)x ;
+}
+
+#endif
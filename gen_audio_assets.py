@@ -0,0 +1,265 @@
+# Asset packer: WAV files to flash-resident mu-law clips for audio_clip.h.
+#
+# Each WAV (16-bit PCM, any rate, mono or stereo) is mixed down to mono,
+# resampled to the engine rate, normalized to a common peak level and
+# encoded as 8-bit G.711 mu-law. Files are read CHUNK frames at a time
+# and written out as they are encoded, so time and memory grow linearly
+# with the input (two passes per file: the first finds the peak, the
+# second encodes). The output depends only on the inputs and the
+# arguments.
+#
+# The resampler is a Kaiser-windowed sinc (windowed_sinc.py, as for the
+# engine's own resampler), evaluated for each output sample's phase.
+# When decimating (a 44.1 kHz file for a 40 kHz engine) the kernel is
+# stretched by the rate ratio, which moves its cutoff below the engine's
+# Nyquist rate, so content between the two rates is filtered out
+# instead of aliasing down.
+#
+# Both formats write the same audio_assets.h (ASSET_<NAME>, the index
+# table audio_assets[]) and an audio_assets.c holding that table:
+#
+#   --format c    the clips are one const array in audio_assets.c
+#   --format bin  the clips go to a self-describing image, linked in by
+#                 the generated assembly file with .incbin as
+#                 audio_asset_image[]
+#
+# Image layout (little endian, audio_asset_image_header and
+# audio_asset_entry in audio_clip.h): a 16-byte header ("SPAA",
+# version, clip count, rate), one 32-byte directory entry per clip
+# (data offset from the start of the image, frames, NUL-padded name),
+# then the clips, each 4-byte aligned.
+#
+# usage: python gen_audio_assets.py --rate 40000 [--normalize -1 | --no-normalize]
+#            --header audio_assets.h --source audio_assets.c
+#            [--format bin --image audio_assets.bin --asm audio_assets.S] a.wav ...
+
+import argparse
+import math
+import operator
+import os
+import re
+import struct
+import wave
+
+from windowed_sinc import design, kernel
+
+CHUNK = 65536               # input frames per read
+
+# Resampling filter: input samples per wing (at the lower of the two
+# rates) and stopband attenuation, well under the mu-law noise floor
+SINC_WIDTH = 16
+SINC_ATTEN = 60.0
+SINC_OVERSAMPLE = 512       # kernel table points per input sample
+
+MULAW_BIAS = 0x84
+MULAW_CLIP = 32635
+
+IMAGE_MAGIC = b"SPAA"
+IMAGE_VERSION = 1
+IMAGE_HEADER = struct.Struct("<4sHHII")     # magic, version, count, rate, reserved
+IMAGE_ENTRY = struct.Struct("<II24s")       # offset, frames, name
+
+parser = argparse.ArgumentParser(description="Pack WAV files into mu-law flash assets")
+parser.add_argument("--rate", type=int, required=True, help="engine sample rate, Hz")
+parser.add_argument("--normalize", type=float, default=-1.0, metavar="DBFS",
+                    help="peak level of every clip (default -1 dBFS)")
+parser.add_argument("--no-normalize", action="store_true", help="keep the recorded levels")
+parser.add_argument("--format", choices=("c", "bin"), default="c")
+parser.add_argument("--header", required=True)
+parser.add_argument("--source", required=True)
+parser.add_argument("--image", help="image file (--format bin)")
+parser.add_argument("--asm", help="assembly file that links the image in (--format bin)")
+parser.add_argument("wavs", nargs="*")
+args = parser.parse_args()
+
+if args.format == "bin" and not (args.image and args.asm):
+    parser.error("--format bin needs --image and --asm")
+
+
+def mulaw(s):
+    sign = 0x80 if s < 0 else 0
+    s = min(abs(s), MULAW_CLIP) + MULAW_BIAS
+    exponent = s.bit_length() - 8
+    mantissa = (s >> (exponent + 3)) & 0x0f
+    return ~(sign | (exponent << 4) | mantissa) & 0xff
+
+
+# Encoder for every 16-bit value, indexed by sample + 32768
+MULAW_TABLE = bytes(mulaw(s) for s in range(-32768, 32768))
+
+
+def asset_name(path):
+    stem = os.path.splitext(os.path.basename(path))[0]
+    return re.sub(r"[^A-Za-z0-9]", "_", stem).upper()
+
+
+class Clip:
+    def __init__(self, path):
+        self.path = path
+        self.name = asset_name(path)
+        with wave.open(path, "rb") as w:
+            if w.getsampwidth() != 2:
+                raise SystemExit("%s: only 16-bit PCM is supported" % path)
+            self.rate_in = w.getframerate()
+            n = w.getnframes()
+        # Output sample k sits at input position k * rate_in / rate
+        self.frames = (n - 1) * args.rate // self.rate_in + 1 if n else 0
+
+        # Pass 1: the peak of the resampled clip (the filter may
+        # overshoot its inputs)
+        peak = 0
+        for y in self.resampled():
+            if y:
+                peak = max(peak, max(y), -min(y))
+        if args.no_normalize or peak == 0:
+            self.gain = 1.0
+        else:
+            self.gain = 32767 * 10 ** (args.normalize / 20.0) / peak
+
+    def mono_chunks(self):
+        """The file as sequences of mono samples, CHUNK frames at a time"""
+        with wave.open(self.path, "rb") as w:
+            channels = w.getnchannels()
+            while True:
+                raw = w.readframes(CHUNK)
+                if not raw:
+                    return
+                pcm = struct.unpack("<%dh" % (len(raw) // 2), raw)
+                if channels == 1:
+                    yield pcm
+                else:
+                    yield [sum(pcm[i:i + channels]) / channels for i in range(0, len(pcm), channels)]
+
+    def resampled(self):
+        """The clip at the engine rate, unscaled, one chunk at a time"""
+        rate_in, rate = self.rate_in, args.rate
+        # Decimating: stretch the kernel, so its cutoff is the engine's
+        # Nyquist rate, and scale it down to keep unity gain
+        stretch = max(1.0, rate_in / rate)
+        reach = int(math.ceil(SINC_WIDTH * stretch))    # inputs each side
+        fc, beta = design(SINC_WIDTH, SINC_ATTEN)
+        wing = [kernel(l / SINC_OVERSAMPLE, SINC_WIDTH, fc, beta)
+                for l in range(SINC_WIDTH * SINC_OVERSAMPLE + 2)]
+
+        def h(t):
+            p = abs(t) / stretch * SINC_OVERSAMPLE
+            l = int(p)
+            if l >= SINC_WIDTH * SINC_OVERSAMPLE:
+                return 0.0
+            return (wing[l] + (wing[l + 1] - wing[l]) * (p - l)) / stretch
+
+        # The filter for each output phase (num % rate), taps for input
+        # samples i - reach + 1 .. i + reach around the position i + frac
+        filters = {}
+        k = 0               # next output sample
+        x = [0.0] * reach   # silence before the clip
+        base = -reach       # input index of x[0]
+        chunks = self.mono_chunks()
+        while k < self.frames:
+            chunk = next(chunks, None)
+            # Silence after the clip, for the last outputs' right wings
+            x.extend(chunk if chunk is not None else [0.0] * (2 * reach + 1))
+            out = []
+            while k < self.frames:
+                num = k * rate_in
+                i = num // rate
+                if i + reach >= base + len(x):
+                    break
+                phase = num % rate
+                taps = filters.get(phase)
+                if taps is None:
+                    frac = phase / rate
+                    taps = filters[phase] = [h(frac - j) for j in range(-reach + 1, reach + 1)]
+                start = i - reach + 1 - base
+                out.append(sum(map(operator.mul, taps, x[start:start + 2 * reach])))
+                k += 1
+            yield out
+            # Drop the inputs no later output reaches
+            drop = (k * rate_in) // rate - reach + 1 - base
+            if drop > 0:
+                del x[:drop]
+                base += drop
+
+    def encode(self):
+        """Pass 2: the mu-law bytes, one chunk at a time"""
+        gain, table = self.gain, MULAW_TABLE
+        for y in self.resampled():
+            out = bytearray()
+            for v in y:
+                s = round(v * gain)
+                out.append(table[min(max(s, -32768), 32767) + 32768])
+            yield out
+
+
+def write_bytes(f, data):
+    for i in range(0, len(data), 24):
+        f.write("    " + ",".join("%d" % b for b in data[i:i + 24]) + ",\n")
+
+
+clips = [Clip(path) for path in args.wavs]
+count = "AUDIO_ASSET_COUNT" if clips else "1"
+
+# Where each clip starts in the image (or in the C array)
+offset = IMAGE_HEADER.size + IMAGE_ENTRY.size * len(clips) if args.format == "bin" else 0
+for clip in clips:
+    offset = (offset + 3) & ~3
+    clip.offset = offset
+    offset += clip.frames
+
+with open(args.header, "w") as f:
+    f.write("// Generated by gen_audio_assets.py - do not edit\n")
+    f.write("#ifndef AUDIO_ASSETS_H\n#define AUDIO_ASSETS_H\n\n")
+    f.write('#include "audio_clip.h"\n\n')
+    f.write("#define AUDIO_ASSETS_RATE %d\n" % args.rate)
+    f.write("#define AUDIO_ASSET_COUNT %d\n\n" % len(clips))
+    for i, clip in enumerate(clips):
+        f.write("#define ASSET_%s %d    // %s, %.2f s\n"
+                % (clip.name, i, os.path.basename(clip.path), clip.frames / args.rate))
+    f.write("\n// Index table: one entry per clip, in flash\n")
+    f.write("extern const audio_clip audio_assets[%s] ;\n" % count)
+    if args.format == "bin":
+        f.write("\n// The packed image, directory header first\n")
+        f.write("extern const uint8_t audio_asset_image[] ;\n")
+    f.write("\n#endif\n")
+
+with open(args.source, "w") as f:
+    f.write("// Generated by gen_audio_assets.py - do not edit\n")
+    f.write('#include "audio_assets.h"\n\n')
+    if args.format == "c":
+        f.write("// All clips back to back (mu-law, each 4-byte aligned)\n")
+        f.write("static const uint8_t __attribute__((aligned(4))) audio_asset_image[] = {\n")
+        pos = 0
+        for clip in clips:
+            f.write("    // %s\n" % clip.name)
+            write_bytes(f, bytes(clip.offset - pos))
+            for data in clip.encode():
+                write_bytes(f, data)
+            pos = clip.offset + clip.frames
+        if not clips:
+            f.write("    0\n")
+        f.write("} ;\n\n")
+    f.write("const audio_clip audio_assets[%s] = {\n" % count)
+    for clip in clips:
+        f.write("    [ASSET_%s] = {audio_asset_image + %d, %d},\n" % (clip.name, clip.offset, clip.frames))
+    f.write("} ;\n")
+
+if args.format == "bin":
+    with open(args.image, "wb") as f:
+        f.write(IMAGE_HEADER.pack(IMAGE_MAGIC, IMAGE_VERSION, len(clips), args.rate, 0))
+        for clip in clips:
+            f.write(IMAGE_ENTRY.pack(clip.offset, clip.frames, clip.name.encode()[:23]))
+        for clip in clips:
+            f.write(bytes(clip.offset - f.tell()))
+            for data in clip.encode():
+                f.write(data)
+
+    with open(args.asm, "w") as f:
+        f.write("/* Generated by gen_audio_assets.py - do not edit */\n")
+        f.write('    .section .rodata.audio_asset_image, "a"\n')
+        f.write("    .balign 4\n")
+        f.write("    .global audio_asset_image\n")
+        f.write("audio_asset_image:\n")
+        f.write('    .incbin "%s"\n' % os.path.abspath(args.image).replace("\\", "/"))
+        f.write("#if defined(__linux__) && defined(__ELF__)\n")
+        f.write('    .section .note.GNU-stack, "", %progbits\n')
+        f.write("#endif\n")
@@ -0,0 +1,134 @@
+# Generates hrir_table.h: short head-related impulse responses (HRIRs)
+# for the spatial audio engine's HRTF mode, computed at build time from
+# the structural model of Brown & Duda (1998):
+#
+#  - head shadow: one-pole/one-zero filter per ear,
+#      H(s) = (1 + alpha*s/(2*w0)) / (1 + s/(2*w0)),  w0 = c/a
+#    with alpha(theta) = 1.05 + 0.95*cos(theta/150deg * 180deg), theta
+#    the angle between the source and the ear's axis (bilinear transform)
+#  - head delay: -a/c*cos(theta) in front of the ear, a/c*(theta-90deg)
+#    behind it (offset so the nearest ear gets none)
+#  - pinna: five echoes whose delays grow with cos(azimuth/2), so a
+#    source behind the head gets a different comb than one in front
+#    (the cue ILD/ITD alone lacks)
+#
+# All delays are realised with a Hann-windowed sinc, after a fixed bulk
+# delay of BULK_DELAY samples so the kernels are not cut off.
+#
+# Taps are written time reversed (oldest input first) as int16 with
+# HRIR_FRAC_BITS fraction bits, so the engine's inner loop is a plain
+# dot product over its history.
+#
+# usage: python gen_hrir_table.py --head-radius 9.0 --speed-sound 34000.0
+#                                 --rate 40000 --taps 64 --step 5 -o hrir_table.h
+
+import argparse
+import math
+
+# Pinna echoes: reflection coefficient, A (samples at 44.1 kHz), B (same)
+PINNA = [(0.5, 1.0, 2.0), (-1.0, 5.0, 4.0), (0.5, 5.0, 7.0), (-0.25, 5.0, 11.0), (0.25, 5.0, 13.0)]
+PINNA_RATE = 44100.0
+
+BULK_DELAY = 4      # samples
+SINC_HALF = 4       # windowed sinc half width, samples
+
+parser = argparse.ArgumentParser(description="Generate the HRIR table")
+parser.add_argument("--head-radius", type=float, required=True, help="a, in cm")
+parser.add_argument("--speed-sound", type=float, required=True, help="c, in cm/s")
+parser.add_argument("--rate", type=int, required=True, help="engine sample rate, Hz")
+parser.add_argument("--taps", type=int, required=True, help="taps per ear")
+parser.add_argument("--step", type=int, required=True, help="azimuth step, degrees")
+parser.add_argument("-o", "--output", required=True)
+args = parser.parse_args()
+
+a_over_c = args.head_radius / args.speed_sound
+taps = args.taps
+
+
+def head_shadow(theta):
+    """Impulse response of the head shadow filter, theta in radians"""
+    alpha = 1.05 + 0.95 * math.cos(theta / math.radians(150.0) * math.pi)
+    k = args.rate * a_over_c          # 2*fs / (2*w0)
+    b0 = (1 + alpha * k) / (1 + k)
+    b1 = (1 - alpha * k) / (1 + k)
+    a1 = (1 - k) / (1 + k)
+    h, x1, y1 = [], 1.0, 0.0
+    for n in range(taps):
+        x = 1.0 if n == 0 else 0.0
+        y = b0 * x + b1 * (x1 if n == 1 else 0.0) - a1 * y1
+        h.append(y)
+        y1 = y
+    return h
+
+
+def head_delay(theta):
+    """Arrival time (s) at an ear, theta from the ear's axis"""
+    if theta < math.pi / 2:
+        return a_over_c * (1 - math.cos(theta))
+    return a_over_c * (1 + theta - math.pi / 2)
+
+
+def add_delayed(out, src, delay, gain):
+    """out += gain * src delayed by delay samples (windowed sinc)"""
+    for m, s in enumerate(src):
+        if s == 0.0:
+            continue
+        centre = m + delay
+        for n in range(int(math.floor(centre)) - SINC_HALF + 1, int(math.floor(centre)) + SINC_HALF + 1):
+            if 0 <= n < taps:
+                t = n - centre
+                sinc = 1.0 if t == 0 else math.sin(math.pi * t) / (math.pi * t)
+                window = 0.5 + 0.5 * math.cos(math.pi * t / SINC_HALF)
+                out[n] += gain * s * sinc * window
+
+
+def hrir(azimuth, ear):
+    """HRIR for a source at azimuth (degrees clockwise) at ear 0 (left) or 1 (right)"""
+    ear_axis = 90.0 if ear else 270.0
+    diff = abs((azimuth - ear_axis + 180.0) % 360.0 - 180.0)
+    theta = math.radians(diff)
+    shadow = head_shadow(theta)
+    base = BULK_DELAY + head_delay(theta) * args.rate
+    front = math.cos(math.radians(((azimuth + 180.0) % 360.0 - 180.0) / 2.0))
+    h = [0.0] * taps
+    add_delayed(h, shadow, base, 1.0)
+    for rho, a, b in PINNA:
+        add_delayed(h, shadow, base + (a * front + b) * args.rate / PINNA_RATE, rho)
+    return h
+
+
+azimuths = list(range(0, 360, args.step))
+table = [[hrir(az, ear) for ear in (0, 1)] for az in azimuths]
+
+# Most fraction bits that keep every tap in int16
+peak = max(abs(x) for pair in table for h in pair for x in h)
+frac_bits = 15
+while peak * (1 << frac_bits) > 32767:
+    frac_bits -= 1
+
+# Worst-case sum of |h| (12-bit signed input, 32-bit accumulator)
+worst = max(sum(abs(x) for x in h) for pair in table for h in pair)
+assert 2048 * worst * (1 << frac_bits) < 2 ** 31, "HRIR accumulator would overflow"
+
+rows = []
+for az, pair in zip(azimuths, table):
+    ears = []
+    for h in pair:
+        q = [int(round(x * (1 << frac_bits))) for x in reversed(h)]
+        ears.append("{" + ", ".join("%d" % v for v in q) + "}")
+    rows.append("    {  // %3d deg\n        %s,\n        %s},"
+                % (az, ears[0], ears[1]))
+
+with open(args.output, "w") as f:
+    f.write("// Generated by gen_hrir_table.py - do not edit\n")
+    f.write("#ifndef HRIR_TABLE_H\n#define HRIR_TABLE_H\n\n")
+    f.write("#include <stdint.h>\n\n")
+    f.write("#define HRIR_TABLE_RATE %d\n" % args.rate)
+    f.write("#define HRIR_TAPS %d\n" % taps)
+    f.write("#define HRIR_AZIMUTH_STEP %d\n" % args.step)
+    f.write("#define HRIR_AZIMUTHS %d\n" % len(azimuths))
+    f.write("#define HRIR_FRAC_BITS %d\n\n" % frac_bits)
+    f.write("// [azimuth / HRIR_AZIMUTH_STEP][EAR_LEFT / EAR_RIGHT][tap], time reversed\n")
+    f.write("static const int16_t hrir_table[HRIR_AZIMUTHS][2][HRIR_TAPS] = {\n")
+    f.write("\n".join(rows))
+    f.write("\n} ;\n\n#endif\n")
@@ -0,0 +1,61 @@
+# Generates resampler_table.h: the windowed-sinc prototype filters of
+# resampler.c, one per quality tier.
+#
+# Each table is the right wing of h(t) = fc * sinc(fc * t) * kaiser(t / width)
+# for t = 0 .. width input samples, OVERSAMPLE points per sample plus a
+# closing zero, where fc is the cutoff as a fraction of the input
+# Nyquist rate. The resampler steps through it at any spacing and
+# interpolates linearly between points (bandlimited interpolation,
+# J. O. Smith), so one table serves every rate ratio; when decimating
+# it stretches the kernel by the ratio instead of needing a new table.
+#
+# The Kaiser beta and cutoff of each tier come from its stopband
+# attenuation (windowed_sinc.py): the transition band ends at the
+# Nyquist rate, so nothing above it aliases back by more than the
+# attenuation allows.
+#
+# Values are int16 with RESAMPLER_FRAC_BITS fraction bits.
+#
+# usage: python gen_resampler_table.py --oversample 128 -o resampler_table.h
+
+import argparse
+
+from windowed_sinc import design, kernel
+
+# Tier name, wing width (input samples), stopband attenuation (dB)
+TIERS = [("FAST", 4, 50.0), ("MEDIUM", 8, 70.0), ("BEST", 16, 90.0)]
+
+FRAC_BITS = 15
+
+parser = argparse.ArgumentParser(description="Generate the resampler filter tables")
+parser.add_argument("--oversample", type=int, required=True, help="table points per input sample")
+parser.add_argument("-o", "--output", required=True)
+args = parser.parse_args()
+
+
+def wing(width, atten):
+    fc, beta = design(width, atten)
+    points = width * args.oversample
+    # The closing point is t = width, where the kernel is zero
+    h = [kernel(l / args.oversample, width, fc, beta) for l in range(points + 1)]
+    q = [int(round(v * (1 << FRAC_BITS))) for v in h]
+    assert max(abs(v) for v in q) < 32768, "resampler taps must fit int16"
+    return fc, q
+
+
+with open(args.output, "w") as f:
+    f.write("// Generated by gen_resampler_table.py - do not edit\n")
+    f.write("#ifndef RESAMPLER_TABLE_H\n#define RESAMPLER_TABLE_H\n\n")
+    f.write("#include <stdint.h>\n\n")
+    f.write("#define RESAMPLER_OVERSAMPLE %d\n" % args.oversample)
+    f.write("#define RESAMPLER_FRAC_BITS %d\n" % FRAC_BITS)
+    for name, width, atten in TIERS:
+        fc, q = wing(width, atten)
+        f.write("\n// %s: %d samples per wing, %.0f dB stopband, cutoff %.3f of Nyquist\n"
+                % (name, width, atten, fc))
+        f.write("#define RESAMPLER_%s_WIDTH %d\n" % (name, width))
+        f.write("static const int16_t resampler_%s_wing[%d] = {\n" % (name.lower(), len(q)))
+        for i in range(0, len(q), 16):
+            f.write("    " + ", ".join("%d" % v for v in q[i:i + 16]) + ",\n")
+        f.write("} ;\n")
+    f.write("\n#endif\n")
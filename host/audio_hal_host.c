@@ -0,0 +1,70 @@
+/**
+ * Host implementation of audio_hal.h
+ *
+ * There is no capture or playback stream: the host tools drive blocks
+ * through host_hal_run_block() at whatever speed they like.
+ */
+
+#include "audio_hal.h"
+#include "host_hal.h"
+#include "isr_profile.h"
+
+// Handlers in attach order (one per simulated core)
+static audio_block_handler_t block_handler[2] ;
+static int handlers ;
+
+static uint16_t adc_codes[3] = {2048, 2048, 2048} ;
+
+// Simulated block timeline for host_hal_profile() (no cost = off)
+static host_hal_cost_t profile_cost ;
+static uint32_t profile_budget ;
+static uint32_t profile_arrival ;           // this block's arrival
+static uint32_t profile_finish[2] ;         // each handler's last exit
+
+void audio_hal_init(void) {
+}
+
+void audio_hal_attach(audio_block_handler_t handler) {
+    if (handlers < 2) block_handler[handlers++] = handler ;
+}
+
+void audio_hal_start(void) {
+}
+
+uint16_t audio_hal_adc_read(unsigned int chan) {
+    return adc_codes[chan] ;
+}
+
+void host_hal_run_block(const uint16_t *in, uint16_t *out) {
+    if (!profile_cost) {
+        for (int i = 0; i < handlers; i++) {
+            block_handler[i](in, out) ;
+        }
+        return ;
+    }
+
+    for (int i = 0; i < handlers; i++) {
+        // Enter at the block's arrival, or when the last call finished
+        uint32_t start = ((int32_t)(profile_finish[i] - profile_arrival) > 0) ?
+                         profile_finish[i] : profile_arrival ;
+        uint32_t busy = profile_cost(i) ;
+        block_handler[i](in, out) ;
+
+        isr_profile_enter(i, start) ;
+        isr_profile_exit(i, start + busy) ;
+        profile_finish[i] = start + busy ;
+    }
+    profile_arrival += profile_budget ;
+}
+
+void host_hal_profile(uint32_t budget, uint32_t ticks_per_us, host_hal_cost_t cost) {
+    isr_profile_init(budget, ticks_per_us, 0xffffffff) ;
+    profile_cost = cost ;
+    profile_budget = budget ;
+    profile_arrival = 0 ;
+    profile_finish[0] = profile_finish[1] = 0 ;
+}
+
+void host_hal_set_adc(unsigned int chan, uint16_t code) {
+    adc_codes[chan] = code & 0xfff ;
+}
@@ -0,0 +1,52 @@
+/**
+ * Timing helpers for the host benchmarks
+ *
+ * bench_cycles() reads the CPU time-stamp counter where there is one
+ * (x86) and falls back to nanoseconds elsewhere; BENCH_UNIT says which.
+ * Host cycles are not RP2040 cycles, but they rank the variants of a
+ * routine the same way and expose regressions in the hot path.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t bench_cycles(void) {
+    return __rdtsc() ;
+}
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_cycles(void) {
+    struct timespec ts ;
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec ;
+}
+#endif
+
+// Wall-clock seconds, for rates per second
+static inline double bench_seconds(void) {
+    struct timespec ts ;
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + ts.tv_nsec * 1e-9 ;
+}
+
+// Keep the optimizer from discarding a benchmark result
+static inline void bench_keep(int32_t v) {
+    __asm__ volatile("" : : "r"(v) : "memory") ;
+}
+
+// Deterministic white noise (xorshift32), so runs are comparable
+static inline uint32_t bench_rand(uint32_t *state) {
+    uint32_t x = *state ;
+    x ^= x << 13 ;
+    x ^= x >> 17 ;
+    x ^= x << 5 ;
+    return *state = x ;
+}
+
+#endif
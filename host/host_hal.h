@@ -0,0 +1,39 @@
+/**
+ * Host-side controls for the simulated audio hardware
+ *
+ * audio_hal_host.c stands in for the ADC/DMA capture and the MCP4822.
+ * The host tools fill one input block of ADC codes, run every attached
+ * block handler on it (in attach order, as if each had its own core),
+ * and decode the DAC words that come back.
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+
+#include "audio_hal.h"
+
+// Run all attached handlers on one block (see audio_block_handler_t).
+// out must be word aligned.
+void host_hal_run_block(const uint16_t *in, uint16_t *out) ;
+
+// Present a 12-bit code to audio_hal_adc_read() (the joystick channel)
+void host_hal_set_adc(unsigned int chan, uint16_t code) ;
+
+// Target ticks a handler's call on the next block costs (a cycle model:
+// host timings carry the host OS's noise, so they cannot gate a budget)
+typedef uint32_t (*host_hal_cost_t)(unsigned int handler) ;
+
+// Record every handler call with isr_profile.h from now on, the way the
+// Pico build does, charging each the ticks cost() returns for it (NULL:
+// stop). Blocks arrive one budget apart on a simulated timeline; a
+// handler still busy when its next block arrives enters late, which
+// shows up as jitter.
+void host_hal_profile(uint32_t budget, uint32_t ticks_per_us, host_hal_cost_t cost) ;
+
+// Convert between signed 16-bit PCM and the 12-bit converter codes
+#define pcm_to_adc12(s) ((uint16_t)(((int)(s) >> 4) + 2048))
+#define dac12_to_pcm(c) ((int16_t)(((int)(c) - 2048) << 4))
+
+#endif
@@ -0,0 +1,1156 @@
+/**
+ * Host benchmarks for the spatial audio engine
+ *
+ * usage: spatial_bench [name ...]
+ *
+ * With no arguments every benchmark runs. Each one prints the cost per
+ * sample in BENCH_UNIT (see bench.h) and, where it applies, an accuracy
+ * figure so speed and quality can be traded off side by side. The exit
+ * status is 1 if an accuracy check failed (fixed, cues), so a run can
+ * gate a change.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_hal.h"
+#include "delay_line.h"
+#include "spatial_audio.h"
+#include "host_hal.h"
+#include "bench.h"
+#include "hrir_table.h"
+#include "azimuth_table.h"
+#include "resampler.h"
+#include "isr_profile.h"
+#include "audio_assets.h"
+
+#define BENCH_SAMPLES 4000000
+
+// Set by benchmarks whose accuracy checks fail (the exit status)
+static int bench_failed ;
+
+//========================================================================
+// Fractional delay interpolators (delay_line.h)
+//========================================================================
+
+enum { INTERP_INTEGER, INTERP_LINEAR, INTERP_LAGRANGE3, INTERP_THIRAN } ;
+
+static const char *interp_names[] = {"integer", "linear", "lagrange3", "thiran"} ;
+
+// Push one sample and read it back at the given delay
+static inline q15 interp_step(int kind, delay_line *d, delay_thiran *t, q15 x, fix15 delay) {
+    delay_line_push(d, x) ;
+    switch (kind) {
+    case INTERP_INTEGER:   return delay_line_tap(d, (delay + (1 << 14)) >> 15) ;
+    case INTERP_LINEAR:    return delay_line_tap_linear(d, delay) ;
+    case INTERP_LAGRANGE3: return delay_line_tap_lagrange3(d, delay) ;
+    default:               return delay_thiran_tap(t, d) ;
+    }
+}
+
+// RMS error (in 12-bit ADC codes) of a delayed full-scale sine, fed in
+// as q15 the way the engine does (codes << 4)
+static double interp_error(int kind, double freq, double delay_samples) {
+    static delay_line d ;
+    delay_thiran t = {0} ;
+    double w = 2.0 * M_PI * freq / AUDIO_SAMPLE_RATE ;
+    fix15 delay = float2fix15(delay_samples) ;
+    double err = 0 ;
+    int count = 0 ;
+
+    memset(&d, 0, sizeof(d)) ;
+    delay_thiran_set(&t, delay) ;
+    for (int n = 0; n < 20000; n++) {
+        q15 x = (q15)lround(16 * 2047.0 * sin(w * n)) ;
+        q15 y = interp_step(kind, &d, &t, x, delay) ;
+        // Skip the start-up transient
+        if (n >= 1000) {
+            double e = y / 16.0 - 2047.0 * sin(w * (n - delay_samples)) ;
+            err += e * e ;
+            count++ ;
+        }
+    }
+    return sqrt(err / count) ;
+}
+
+static void bench_delay(void) {
+    printf("fractional delay: %s/sample, RMS error in ADC codes at delay 12.37\n", BENCH_UNIT) ;
+    printf("  %-10s %10s %10s %10s\n", "order", "cost", "1 kHz", "8 kHz") ;
+
+    for (int kind = INTERP_INTEGER; kind <= INTERP_THIRAN; kind++) {
+        static delay_line d ;
+        delay_thiran t = {0} ;
+        uint32_t seed = 1 ;
+        int32_t acc = 0 ;
+
+        delay_thiran_set(&t, float2fix15(12.37)) ;
+        uint64_t start = bench_cycles() ;
+        for (int n = 0; n < BENCH_SAMPLES; n++) {
+            // Sweep the delay slowly through every fraction
+            fix15 delay = int2fix15(4) + ((n >> 4) & 0x7ffff) ;
+            q15 x = (q15)bench_rand(&seed) ;
+            acc += interp_step(kind, &d, &t, x, delay) ;
+        }
+        uint64_t cycles = bench_cycles() - start ;
+        bench_keep(acc) ;
+
+        printf("  %-10s %10.2f %10.3f %10.3f\n", interp_names[kind],
+               (double)cycles / BENCH_SAMPLES,
+               interp_error(kind, 1000.0, 12.37), interp_error(kind, 8000.0, 12.37)) ;
+    }
+}
+
+//========================================================================
+// Whole engine: both ears' block handlers on white noise
+//========================================================================
+
+// Attach both ears once, the way final.c does on the two cores
+static void attach_engine(void) {
+    static int attached ;
+    if (!attached) {
+        audio_hal_attach(spatial_block_core_0) ;
+        audio_hal_attach(spatial_block_core_1) ;
+        attached = 1 ;
+    }
+}
+
+// Extra ADC voices, 40 degrees apart at a low level, on top of the two
+// the engine starts with
+static int extra_voice[SPATIAL_MAX_VOICES] ;
+static int extra_voices ;
+
+// Allocate extra voices until voices are active
+static void add_voices(int voices) {
+    while (spatial_voices_active() < voices) {
+        int voice = spatial_voice_alloc(ADC_CHAN_1, 40 * extra_voices, float2fix15(0.1)) ;
+        if (voice < 0) break ;
+        extra_voice[extra_voices++] = voice ;
+    }
+}
+
+// Free every extra voice
+static void free_voices(void) {
+    while (extra_voices > 0) spatial_voice_free(extra_voice[--extra_voices]) ;
+}
+
+// Run silent blocks through handler until every history is flushed and
+// every ramp has finished, so what follows starts from a known state
+static void run_silence(audio_block_handler_t handler) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t __attribute__((aligned(4))) out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) in[i] = 2048 ;
+    for (int b = 0; b < DELAY_LINE_LENGTH / AUDIO_BLOCK_SIZE + 2; b++) handler(in, out) ;
+}
+
+static void bench_engine(void) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    uint32_t seed = 1 ;
+    int blocks = BENCH_SAMPLES / AUDIO_BLOCK_SIZE ;
+    uint64_t cycles = 0 ;
+
+    attach_engine() ;
+    spatial_set_azimuth(SOURCE_R, 60, float2fix15(0.5)) ;
+    spatial_set_azimuth(SOURCE_L, 250, float2fix15(0.5)) ;
+
+    for (int b = 0; b < blocks; b++) {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) {
+            in[i] = bench_rand(&seed) & 0xfff ;
+        }
+        uint64_t start = bench_cycles() ;
+        host_hal_run_block(in, out) ;
+        cycles += bench_cycles() - start ;
+        bench_keep(out[0]) ;
+    }
+
+    printf("engine: %.2f %s per stereo sample, %.1f per %d-sample block\n",
+           (double)cycles / (blocks * AUDIO_BLOCK_SIZE), BENCH_UNIT,
+           (double)cycles / blocks, AUDIO_BLOCK_SIZE) ;
+}
+
+//========================================================================
+// Click energy of direction changes (spatial_set_ramp on and off)
+//========================================================================
+
+#define CLICK_BLOCKS      2500      // 2 s at 40 kHz
+#define CLICK_MOVE_EVERY  25        // blocks between joystick moves
+#define CLICK_TONE_HZ     440.0
+#define CLICK_TONE_CODES  600.0     // amplitude, ADC codes
+
+// Render a 440 Hz tone on both sources, optionally flipping the joystick
+// between zones 0 and 3 every CLICK_MOVE_EVERY blocks, and return the
+// energy of the high-passed output (second difference, which leaves a
+// tone this low 30 dB down but passes the steps of a click)
+static double click_energy(int move, double *peak) {
+    uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    int prev[2][2] = {{0}} ;
+    double energy = 0 ;
+    long n = 0 ;
+
+    attach_engine() ;
+    spatial_set_direction(0) ;
+    *peak = 0 ;
+
+    for (int b = 0; b < CLICK_BLOCKS; b++) {
+        if (move && b % CLICK_MOVE_EVERY == 0) spatial_set_direction((b / CLICK_MOVE_EVERY) & 1 ? 3 : 0) ;
+
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++, n++) {
+            double x = CLICK_TONE_CODES * sin(2 * M_PI * CLICK_TONE_HZ * n / AUDIO_SAMPLE_RATE) ;
+            uint16_t code = (uint16_t)lround(2048 + x) ;
+            in[AUDIO_IN_CHANNELS * i + ADC_CHAN_0] = code ;
+            in[AUDIO_IN_CHANNELS * i + ADC_CHAN_1] = 2048 ;
+            in[AUDIO_IN_CHANNELS * i + ADC_CHAN_2] = code ;
+        }
+        host_hal_run_block(in, out) ;
+
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            for (int c = 0; c < 2; c++) {
+                int y = out[AUDIO_OUT_CHANNELS * i + c] & 0xfff ;
+                // Skip the first block while the ramps settle from silence
+                if (b > 0) {
+                    double hp = y - 2 * prev[c][0] + prev[c][1] ;
+                    energy += hp * hp ;
+                    if (fabs(hp) > *peak) *peak = fabs(hp) ;
+                }
+                prev[c][1] = prev[c][0] ;
+                prev[c][0] = y ;
+            }
+        }
+    }
+    return energy ;
+}
+
+static void bench_click(void) {
+    double peak_still, peak_jump, peak_ramp ;
+
+    spatial_set_ramp(1) ;
+    double still = click_energy(0, &peak_still) ;
+    spatial_set_ramp(0) ;
+    double jump = click_energy(1, &peak_jump) ;
+    spatial_set_ramp(1) ;
+    double ramp = click_energy(1, &peak_ramp) ;
+
+    printf("click: high-pass energy of %d direction changes (codes^2, peak codes)\n",
+           CLICK_BLOCKS / CLICK_MOVE_EVERY) ;
+    printf("  no moves      %12.0f  %6.0f\n", still, peak_still) ;
+    printf("  jump          %12.0f  %6.0f  click %+.1f dB\n", jump, peak_jump, 10 * log10(jump / still)) ;
+    printf("  ramp          %12.0f  %6.0f  click %+.1f dB\n", ramp, peak_ramp, 10 * log10(ramp / still)) ;
+}
+
+//========================================================================
+// HRTF mode cycle budget
+//========================================================================
+
+// RP2040 system clock, and the cost of one FIR tap on the M0+: two
+// LDRSH (2 cycles each), MULS (1, single-cycle multiplier) and ADDS (1),
+// with the loop overhead amortised by the 4x unroll
+#define M0_CLOCK_HZ       125000000.0
+#define M0_CYCLES_PER_TAP 6.5
+
+// Host cycles per block of one ear in the given mode
+static double mode_cost(int mode) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    uint32_t seed = 1 ;
+    int blocks = BENCH_SAMPLES / AUDIO_BLOCK_SIZE / 8 ;
+    uint64_t cycles = 0 ;
+
+    spatial_set_mode(mode) ;
+    spatial_set_azimuth(SOURCE_R, 60, float2fix15(0.5)) ;
+    spatial_set_azimuth(SOURCE_L, 250, float2fix15(0.5)) ;
+    for (int b = 0; b < blocks; b++) {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) {
+            in[i] = bench_rand(&seed) & 0xfff ;
+        }
+        uint64_t start = bench_cycles() ;
+        spatial_block_core_0(in, out) ;
+        cycles += bench_cycles() - start ;
+        bench_keep(out[1]) ;
+    }
+    spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+    return (double)cycles / blocks ;
+}
+
+static void bench_hrtf(void) {
+    double ild = mode_cost(SPATIAL_MODE_ILD_ITD) ;
+    double hrtf = mode_cost(SPATIAL_MODE_HRTF) ;
+    int taps = 2 * HRIR_TAPS ;      // both sources, per ear sample
+    double budget = M0_CLOCK_HZ / AUDIO_SAMPLE_RATE ;
+    double m0 = taps * M0_CYCLES_PER_TAP ;
+
+    printf("hrtf: %d taps x 2 sources per ear, %d azimuths, one ear per core\n",
+           HRIR_TAPS, HRIR_AZIMUTHS) ;
+    printf("  host  ild/itd %8.2f %s per ear sample\n", ild / AUDIO_BLOCK_SIZE, BENCH_UNIT) ;
+    printf("  host  hrtf    %8.2f %s per ear sample (%.1fx)\n",
+           hrtf / AUDIO_BLOCK_SIZE, BENCH_UNIT, hrtf / ild) ;
+    printf("  M0+   hrtf    %8.0f cycles per ear sample (%.1f per tap model)\n", m0, M0_CYCLES_PER_TAP) ;
+    printf("  budget        %8.0f cycles per sample at %.0f MHz, %d Hz: %.0f%% of one core\n",
+           budget, M0_CLOCK_HZ / 1e6, AUDIO_SAMPLE_RATE, 100 * m0 / budget) ;
+    printf("                %.0f%% with both ears on one core; a crossfade block costs double\n",
+           200 * m0 / budget) ;
+}
+
+//========================================================================
+// Voice pool: cost per frame against active voices
+//========================================================================
+
+#define VOICE_BLOCKS 100    // per trial
+#define VOICE_TRIALS 40     // best of, to ride out host noise
+
+// Best-of-trials host cycles per stereo frame (both ears) with the
+// voices currently allocated
+static double frame_cost(void) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    uint32_t seed = 1 ;
+    double best = 0 ;
+
+    for (int t = 0; t < VOICE_TRIALS; t++) {
+        uint64_t cycles = 0 ;
+        for (int b = 0; b < VOICE_BLOCKS; b++) {
+            for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) {
+                in[i] = bench_rand(&seed) & 0xfff ;
+            }
+            uint64_t start = bench_cycles() ;
+            host_hal_run_block(in, out) ;
+            cycles += bench_cycles() - start ;
+            bench_keep(out[0]) ;
+        }
+        double cost = (double)cycles / (VOICE_BLOCKS * AUDIO_BLOCK_SIZE) ;
+        if (t == 0 || cost < best) best = cost ;
+    }
+    return best ;
+}
+
+static void bench_voices(void) {
+    double sn = 0, snn = 0, si = 0, sni = 0, sh = 0, snh = 0 ;
+    int points = 0 ;
+
+    attach_engine() ;
+    printf("voices: %s per stereo frame (best of %d), by active voices\n", BENCH_UNIT, VOICE_TRIALS) ;
+    printf("  voices   ild/itd      hrtf\n") ;
+
+    // The two ADC voices are always there; add the rest one at a time
+    for (int n = spatial_voices_active(); n <= SPATIAL_MAX_VOICES; n++) {
+        add_voices(n) ;
+        spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+        double ild = frame_cost() ;
+        spatial_set_mode(SPATIAL_MODE_HRTF) ;
+        double hrtf = frame_cost() ;
+        printf("  %6d  %8.1f  %8.1f\n", n, ild, hrtf) ;
+
+        sn += n ; snn += (double)n * n ; points++ ;
+        si += ild ; sni += n * ild ;
+        sh += hrtf ; snh += n * hrtf ;
+    }
+
+    // Least-squares slope: the cost of one more voice
+    double var = points * snn - sn * sn ;
+    printf("  per voice %6.1f  %8.1f\n", (points * sni - sn * si) / var, (points * snh - sn * sh) / var) ;
+
+    // Pool exhausted: allocation must fail
+    printf("  alloc past %d voices: %d\n", SPATIAL_MAX_VOICES, spatial_voice_alloc(ADC_CHAN_1, 0, 0)) ;
+
+    int stale = extra_voice[0] ;
+    free_voices() ;
+    spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+
+    // Stale and bogus handles must leave the pool alone
+    int active = spatial_voices_active() ;
+    spatial_voice_free(stale) ;
+    spatial_voice_free(-1) ;
+    spatial_voice_free(SPATIAL_MAX_VOICES) ;
+    spatial_set_azimuth(stale, 90, 0) ;
+    int a = spatial_voice_alloc(ADC_CHAN_1, 0, 0), b = spatial_voice_alloc(ADC_CHAN_1, 0, 0) ;
+    int ok = spatial_voices_active() == active + 2 && a >= 0 && b >= 0 && a != b ;
+    printf("  double free: %s\n", ok ? "ignored" : "FAIL") ;
+    if (!ok) bench_failed = 1 ;
+    spatial_voice_free(a) ;
+    spatial_voice_free(b) ;
+}
+
+//========================================================================
+// Flash clip decoding (audio_clip.h)
+//========================================================================
+
+static void bench_clip(void) {
+    if (AUDIO_ASSET_COUNT == 0) return ;
+
+    const audio_clip *clip = &audio_assets[0] ;
+    audio_clip_reader r ;
+    q15 block[AUDIO_BLOCK_SIZE] ;
+    uint64_t cycles = 0 ;
+    long samples = 0 ;
+
+    for (int pass = 0; pass < 4; pass++) {
+        audio_clip_start(&r, clip) ;
+        uint64_t start = bench_cycles() ;
+        while (!audio_clip_finished(&r)) {
+            audio_clip_read(&r, block, AUDIO_BLOCK_SIZE, false) ;
+            bench_keep(block[0]) ;
+            samples += AUDIO_BLOCK_SIZE ;
+        }
+        cycles += bench_cycles() - start ;
+    }
+
+    printf("clip: %lu samples (%.2f s, one byte each in flash), decode %.2f %s per sample\n",
+           (unsigned long)clip->frames, (double)clip->frames / AUDIO_SAMPLE_RATE,
+           (double)cycles / samples, BENCH_UNIT) ;
+}
+
+//========================================================================
+// Sample-rate conversion (resampler.h)
+//========================================================================
+
+#define RESAMPLE_OUTPUTS  200000    // per cost measurement
+#define RESAMPLE_SETTLE   500       // outputs skipped before measuring THD+N
+#define RESAMPLE_LEVEL    16384.0   // test tone amplitude (-6 dBFS)
+
+// M0+ cycles per kernel tap: three LDRSH for the table points and the
+// sample, the table interpolation (SUBS, MULS, ASRS, ADDS), MULS, a
+// 64-bit accumulate (ASRS, ADDS, ADCS) and the index step and loop test
+#define M0_CYCLES_PER_RESAMPLE_TAP 16.0
+
+static const char *resample_names[] = {"linear", "fast", "medium", "best"} ;
+
+// Convert n outputs of the input produced by gen(), in engine blocks.
+// Returns host cycles spent in the resampler.
+static uint64_t resample_run(resampler *r, int16_t (*gen)(long, double), double arg,
+                             int16_t *out, long n) {
+    int16_t buf[RESAMPLER_BUFFER] ;
+    long next = 0 ;
+    uint64_t cycles = 0 ;
+
+    for (long k = 0; k < n; k += AUDIO_BLOCK_SIZE) {
+        int need = resampler_input_needed(r, AUDIO_BLOCK_SIZE) ;
+        for (int i = 0; i < need; i++) buf[i] = gen(next++, arg) ;
+
+        uint64_t start = bench_cycles() ;
+        resampler_write(r, buf, need) ;
+        resampler_read(r, &out[k], AUDIO_BLOCK_SIZE) ;
+        cycles += bench_cycles() - start ;
+    }
+    return cycles ;
+}
+
+static int16_t resample_noise(long n, double unused) {
+    static uint32_t seed = 1 ;
+    (void)n ; (void)unused ;
+    return (int16_t)bench_rand(&seed) ;
+}
+
+// arg: tone frequency over input rate
+static int16_t resample_tone(long n, double arg) {
+    return (int16_t)lround(RESAMPLE_LEVEL * sin(2 * M_PI * arg * n)) ;
+}
+
+// THD+N (dB) of a tone converted from rate_in to the engine rate,
+// against the ideal tone at the engine rate
+static double resample_thdn(int quality, int rate_in, double freq) {
+    static int16_t out[20000] ;
+    long n = sizeof(out) / sizeof(out[0]) ;
+    resampler r ;
+    double err = 0, ref = 0 ;
+
+    resampler_init(&r, rate_in, AUDIO_SAMPLE_RATE, quality) ;
+    resample_run(&r, resample_tone, freq / rate_in, out, n) ;
+    for (long k = RESAMPLE_SETTLE; k < n; k++) {
+        double y = RESAMPLE_LEVEL * sin(2 * M_PI * freq * k / AUDIO_SAMPLE_RATE) ;
+        err += (out[k] - y) * (out[k] - y) ;
+        ref += y * y ;
+    }
+    return 10 * log10(err / ref) ;
+}
+
+static void bench_resample(void) {
+    static int16_t out[RESAMPLE_OUTPUTS] ;
+    static const int rates[] = {44100, 22050} ;
+    static const double tones[] = {1000.0, 4000.0, 8000.0, 12000.0} ;
+    double budget = M0_CLOCK_HZ / AUDIO_SAMPLE_RATE ;
+
+    printf("resample: to %d Hz; %s per output sample, THD+N (dB) of a -6 dBFS tone\n",
+           AUDIO_SAMPLE_RATE, BENCH_UNIT) ;
+    printf("  %-7s %6s %5s %8s %6s %8s %8s %8s %8s\n", "tier", "from", "taps", "cost",
+           "M0+", "1 kHz", "4 kHz", "8 kHz", "12 kHz") ;
+
+    for (int q = RESAMPLER_LINEAR; q <= RESAMPLER_BEST; q++) {
+        for (unsigned int i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            resampler r ;
+            resampler_init(&r, rates[i], AUDIO_SAMPLE_RATE, q) ;
+            int taps = 2 * r.half_width ;
+            uint64_t cycles = resample_run(&r, resample_noise, 0, out, RESAMPLE_OUTPUTS) ;
+            bench_keep(out[RESAMPLE_OUTPUTS - 1]) ;
+            double m0 = taps * M0_CYCLES_PER_RESAMPLE_TAP ;
+
+            printf("  %-7s %6d %5d %8.1f %5.0f%%", resample_names[q], rates[i], taps,
+                   (double)cycles / RESAMPLE_OUTPUTS, 100 * m0 / budget) ;
+            for (unsigned int f = 0; f < sizeof(tones) / sizeof(tones[0]); f++) {
+                // Tones the input rate can't carry are left out
+                if (2 * tones[f] < rates[i]) printf(" %8.1f", resample_thdn(q, rates[i], tones[f])) ;
+                else printf(" %8s", "-") ;
+            }
+            printf("\n") ;
+        }
+    }
+    printf("  M0+: %.0f cycles per tap model, share of one core at %.0f MHz\n",
+           M0_CYCLES_PER_RESAMPLE_TAP, M0_CLOCK_HZ / 1e6) ;
+}
+
+//========================================================================
+// Block interrupt profile (isr_profile.h) from modelled M0+ cycles
+//========================================================================
+
+#define PROFILE_BLOCKS 5000     // 4 s at 40 kHz
+
+// Profile both handlers over PROFILE_BLOCKS blocks of noise
+static void profile_run(const char *label) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    uint32_t seed = 1 ;
+
+    isr_profile_reset() ;
+    for (int b = 0; b < PROFILE_BLOCKS; b++) {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) {
+            in[i] = bench_rand(&seed) & 0xfff ;
+        }
+        host_hal_run_block(in, out) ;
+    }
+    printf("%s\n", label) ;
+    isr_profile_print() ;
+}
+
+// M0+ cycle model of one block on one core (one ear), so the profile
+// is the same on every run: per voice and sample, the q15 tap and gain
+// of the mixer models below plus the history write (ILD/ITD), or the
+// FIR (hrtf above) plus the history copy (HRTF); per sample the input
+// slice and the DAC word; per block the parameter read and the loops
+#define M0_CYCLES_ILD_VOICE  (11.0 + 12.0 + 4.0)
+#define M0_CYCLES_HRTF_VOICE (HRIR_TAPS * M0_CYCLES_PER_TAP + 4.0)
+#define M0_CYCLES_SAMPLE     12.0
+#define M0_CYCLES_BLOCK      400.0
+
+static int profile_mode ;
+
+// Both ears cost the same
+static uint32_t profile_cost(unsigned int handler) {
+    (void)handler ;
+    double voice = (profile_mode == SPATIAL_MODE_HRTF) ? M0_CYCLES_HRTF_VOICE : M0_CYCLES_ILD_VOICE ;
+    return (uint32_t)(M0_CYCLES_BLOCK + AUDIO_BLOCK_SIZE * (M0_CYCLES_SAMPLE + spatial_voices_active() * voice)) ;
+}
+
+// Switch the engine and the cycle model together
+static void profile_set_mode(int mode) {
+    spatial_set_mode(mode) ;
+    profile_mode = mode ;
+}
+
+static void bench_profile(void) {
+    attach_engine() ;
+
+    printf("profile: modelled M0+ cycles (per voice and ear sample %.0f ild/itd, %.0f hrtf) on a simulated %.0f MHz timeline\n",
+           M0_CYCLES_ILD_VOICE, M0_CYCLES_HRTF_VOICE, M0_CLOCK_HZ / 1e6) ;
+    host_hal_profile((uint32_t)(M0_CLOCK_HZ * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE),
+                     (uint32_t)(M0_CLOCK_HZ / 1e6), profile_cost) ;
+
+    profile_set_mode(SPATIAL_MODE_ILD_ITD) ;
+    profile_run("-- ild/itd, 2 voices") ;
+
+    add_voices(SPATIAL_MAX_VOICES) ;
+    profile_set_mode(SPATIAL_MODE_HRTF) ;
+    profile_run("-- hrtf, 8 voices") ;
+
+    free_voices() ;
+    spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+    host_hal_profile(0, 1, NULL) ;  // off
+}
+
+//========================================================================
+// One core for both ears (spatial_block_stereo) against one per ear
+//========================================================================
+
+#define STEREO_BLOCKS 200       // per trial
+#define STEREO_TRIALS 20        // best of
+#define STEREO_COMPARE_BLOCKS 100
+
+// M0+ cycles per host cycle, to show the timed handlers as a share of
+// one core. A fixed ratio, so the pair and the stereo handler scale the
+// same way: the HRTF FIR's M0+ model (hrtf above) against what it costs
+// on a quiet x86 host, about 830 against 160 cycles per ear sample.
+// The host vectorises that FIR, so scalar code comes out pessimistic.
+#define M0_CYCLES_PER_HOST_CYCLE 5.0
+
+// Host cycles per block of each handler
+typedef struct {
+    double core_0 ;
+    double core_1 ;
+    double stereo ;
+} stereo_cost ;
+
+// Best-of-trials host cycles per block with the voices currently
+// allocated. The handlers are called directly: the pair in turn, then
+// the stereo handler over the same input.
+static stereo_cost stereo_costs(void) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t __attribute__((aligned(4))) out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    stereo_cost best = {0} ;
+
+    for (int t = 0; t < STEREO_TRIALS; t++) {
+        uint64_t c0 = 0, c1 = 0, cs = 0 ;
+        uint32_t seed = 1 ;
+        for (int b = 0; b < STEREO_BLOCKS; b++) {
+            for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) in[i] = bench_rand(&seed) & 0xfff ;
+            uint64_t start = bench_cycles() ;
+            spatial_block_core_0(in, out) ;
+            c0 += bench_cycles() - start ;
+            start = bench_cycles() ;
+            spatial_block_core_1(in, out) ;
+            c1 += bench_cycles() - start ;
+        }
+        seed = 1 ;
+        for (int b = 0; b < STEREO_BLOCKS; b++) {
+            for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) in[i] = bench_rand(&seed) & 0xfff ;
+            uint64_t start = bench_cycles() ;
+            spatial_block_stereo(in, out) ;
+            cs += bench_cycles() - start ;
+        }
+        bench_keep(out[0]) ;
+        if (t == 0 || c0 < best.core_0) best.core_0 = c0 ;
+        if (t == 0 || c1 < best.core_1) best.core_1 = c1 ;
+        if (t == 0 || cs < best.stereo) best.stereo = cs ;
+    }
+    best.core_0 /= STEREO_BLOCKS ;
+    best.core_1 /= STEREO_BLOCKS ;
+    best.stereo /= STEREO_BLOCKS ;
+    return best ;
+}
+
+// The pair of handlers, one after the other into the same block
+static void stereo_pair_block(const uint16_t *in, uint16_t *out) {
+    spatial_block_core_0(in, out) ;
+    spatial_block_core_1(in, out) ;
+}
+
+// Render the same noise with the pair of handlers or the stereo one,
+// from silent histories, into out (STEREO_COMPARE_BLOCKS blocks)
+static void stereo_render(int stereo, uint16_t *out) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    audio_block_handler_t handler = stereo ? spatial_block_stereo : stereo_pair_block ;
+    uint32_t seed = 1 ;
+
+    run_silence(handler) ;
+    for (int b = 0; b < STEREO_COMPARE_BLOCKS; b++) {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) in[i] = bench_rand(&seed) & 0xfff ;
+        handler(in, &out[b * AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS]) ;
+    }
+}
+
+// Largest difference, in DAC codes, between the two designs' output
+static int stereo_difference(void) {
+    static uint16_t __attribute__((aligned(4))) out[2][STEREO_COMPARE_BLOCKS * AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    int worst = 0 ;
+
+    stereo_render(0, out[0]) ;
+    stereo_render(1, out[1]) ;
+    for (int i = 0; i < STEREO_COMPARE_BLOCKS * AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS; i++) {
+        int d = abs((out[0][i] & 0xfff) - (out[1][i] & 0xfff)) ;
+        if (d > worst) worst = d ;
+    }
+    return worst ;
+}
+
+static void bench_stereo(void) {
+    double budget = M0_CLOCK_HZ * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE ;
+
+    printf("stereo: both ears on one core (spatial_block_stereo) against one core per ear\n") ;
+    printf("  %s per block, best of %d; M0+ %% of one core (busiest core of the pair, or the\n  stereo one) at %.1f M0+ cycles per host cycle\n",
+           BENCH_UNIT, STEREO_TRIALS, M0_CYCLES_PER_HOST_CYCLE) ;
+    printf("  %-8s %6s %9s %9s %9s %9s %7s %9s %8s\n", "mode", "voices", "core 0", "core 1",
+           "pair sum", "stereo", "/sum", "M0+ busy", "stereo") ;
+
+    for (int mode = SPATIAL_MODE_ILD_ITD; mode <= SPATIAL_MODE_HRTF; mode++) {
+        spatial_set_mode(mode) ;
+        for (int voices = 2; voices <= SPATIAL_MAX_VOICES; voices += SPATIAL_MAX_VOICES - 2) {
+            add_voices(voices) ;
+            stereo_cost c = stereo_costs() ;
+            double busiest = c.core_0 > c.core_1 ? c.core_0 : c.core_1 ;
+            // Each voice is rounded to DAC codes once in the stereo mix
+            int diff = stereo_difference() ;
+            printf("  %-8s %6d %9.0f %9.0f %9.0f %9.0f %6.2fx %8.0f%% %7.0f%%  diff %d codes (bound %d: %s)\n",
+                   mode == SPATIAL_MODE_HRTF ? "hrtf" : "ild/itd", voices, c.core_0, c.core_1,
+                   c.core_0 + c.core_1, c.stereo, c.stereo / (c.core_0 + c.core_1),
+                   100 * busiest * M0_CYCLES_PER_HOST_CYCLE / budget,
+                   100 * c.stereo * M0_CYCLES_PER_HOST_CYCLE / budget, diff, voices,
+                   diff <= voices ? "ok" : "EXCEEDED") ;
+            if (diff > voices) bench_failed = 1 ;
+        }
+        free_voices() ;
+    }
+    printf("  (each ear's output differs by at most one code per voice: the stereo mix\n"
+           "   rounds every voice to DAC codes to fit its 16-bit lanes)\n") ;
+    printf("  M0+ figures are host estimates; on the target, compare the 'p' console of a\n"
+           "  -DSPATIAL_ONE_CORE=ON build with the default one (not measured here)\n") ;
+    spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+}
+
+//========================================================================
+// Integer sample path against a float reference (ILD/ITD)
+//========================================================================
+
+#define FIXED_BLOCKS     5000       // 4 s at 40 kHz
+#define FIXED_MOVE_EVERY 10         // blocks between random moves
+#define FIXED_BOUND      2          // largest error accepted, DAC codes
+#define FIXED_TRIALS     5          // best of, for the cycle counts
+
+// M0+ cycle models for one voice at one ear on the steady path. Float:
+// the interpolation (fsub, fmul, fadd), the gain (fmul) and the mix
+// (fadd) through the ROM soft-float routines, about 60 cycles each.
+// fix15 with 64-bit products: two __aeabi_lmul calls, about 25 cycles
+// each. q15: LDRSH x2, SUBS, MULS, ASRS, ADDS for the tap and MULS,
+// ASRS, ADDS for the gain, all single-cycle but the loads. Each adds
+// about 12 cycles of push, indexing and loop.
+#define M0_CYCLES_PER_FLOAT_OP 60.0
+#define M0_CYCLES_PER_LMUL     25.0
+#define M0_CYCLES_FLOAT_VOICE  (5 * M0_CYCLES_PER_FLOAT_OP + 12.0)
+#define M0_CYCLES_FIX15_VOICE  (2 * M0_CYCLES_PER_LMUL + 6.0 + 12.0)
+#define M0_CYCLES_Q15_VOICE    (11.0 + 12.0)
+
+// One voice's history and cues in float, in ADC codes
+typedef struct {
+    float history[DELAY_LINE_LENGTH] ;
+    unsigned int head ;
+    float gain ;
+    float delay ;
+} float_voice ;
+
+// The engine's fractional tap (DELAY_LINE_INTERP) in float
+static inline float float_tap(const float_voice *v, float delay) {
+    unsigned int n = (unsigned int)delay ;
+    float frac = delay - n ;
+    float y0 = v->history[(v->head - n) & DELAY_LINE_MASK] ;
+    float y1 = v->history[(v->head - n - 1) & DELAY_LINE_MASK] ;
+#if DELAY_LINE_INTERP == 3
+    if (n > 0) {
+        float ym1 = v->history[(v->head - n + 1) & DELAY_LINE_MASK] ;
+        float y2 = v->history[(v->head - n - 2) & DELAY_LINE_MASK] ;
+        float c1 = y1 - ym1 / 3 - y0 / 2 - y2 / 6 ;
+        float c2 = (ym1 + y1) / 2 - y0 ;
+        float c3 = (y2 - ym1) / 6 + (y0 - y1) / 2 ;
+        return y0 + frac * (c1 + frac * (c2 + frac * c3)) ;
+    }
+#endif
+    return y0 + (y1 - y0) * frac ;
+}
+
+// voice_block_ild in float: the same ramp and crossfade schedule, with
+// exact gains and no rounding
+static void float_voice_block(float_voice *v, float gain_to, float delay_to, const float *x, float *mix) {
+    float gain_step = (gain_to - v->gain) / AUDIO_BLOCK_SIZE ;
+
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        v->head = (v->head + 1) & DELAY_LINE_MASK ;
+        v->history[v->head] = x[i] ;
+        float fade = (float)(i + 1) / AUDIO_BLOCK_SIZE ;
+        float y = float_tap(v, v->delay) ;
+        if (delay_to != v->delay) y += (float_tap(v, delay_to) - y) * fade ;
+        mix[i] += y * (v->gain + gain_step * (i + 1)) ;
+    }
+    v->gain = gain_to ;
+    v->delay = delay_to ;
+}
+
+typedef struct {
+    uint64_t fixed_cycles ;     // engine, both ears
+    uint64_t float_cycles ;     // reference, both ears
+    long histogram[FIXED_BOUND + 2] ;   // errors 0 .. FIXED_BOUND, then larger
+    double err2 ;
+    int worst ;
+} fixed_result ;
+
+// Run the engine and the reference side by side on the same input and
+// moves, and tally the differences
+static void fixed_run(fixed_result *r) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    static float_voice ref[2][2] ;                              // [ear][voice]
+    static const int source[2] = {SOURCE_R, SOURCE_L} ;
+    static const unsigned int chan[2] = {ADC_CHAN_2, ADC_CHAN_0} ;
+    int azimuth[2] = {45, 315} ;
+    fix15 level[2] = {float2fix15(0.5), float2fix15(0.5)} ;
+    uint32_t seed = 1 ;
+    long n = 0 ;
+
+    memset(r, 0, sizeof(*r)) ;
+
+    attach_engine() ;
+    spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+    spatial_set_ramp(1) ;
+    for (int s = 0; s < 2; s++) spatial_set_azimuth(source[s], azimuth[s], level[s]) ;
+
+    // Both sides start from silent histories and finished ramps
+    run_silence(host_hal_run_block) ;
+    memset(ref, 0, sizeof(ref)) ;
+    for (int ear = 0; ear < 2; ear++) {
+        for (int s = 0; s < 2; s++) {
+            const azimuth_cue *cue = &azimuth_table[azimuth[s]] ;
+            ref[ear][s].gain = (float)cue->gain[ear] * level[s] / (32768.0f * 32768.0f) ;
+            ref[ear][s].delay = cue->delay[ear] / 32768.0f ;
+        }
+    }
+
+    for (int b = 0; b < FIXED_BLOCKS; b++) {
+        if (b % FIXED_MOVE_EVERY == 0) {
+            for (int s = 0; s < 2; s++) {
+                if (b > 0) {
+                    azimuth[s] = bench_rand(&seed) % AZIMUTH_STEPS ;
+                    level[s] = float2fix15(0.1) + bench_rand(&seed) % float2fix15(0.9) ;
+                }
+                spatial_set_azimuth(source[s], azimuth[s], level[s]) ;
+            }
+        }
+
+        // A tone plus noise on each source, near full scale between them
+        float x[2][AUDIO_BLOCK_SIZE] ;
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++, n++) {
+            for (int s = 0; s < 2; s++) {
+                double tone = 900.0 * sin(2 * M_PI * (300.0 + 700.0 * s) * n / AUDIO_SAMPLE_RATE) ;
+                int code = 2048 + (int)lround(tone) + (int)(bench_rand(&seed) % 1801) - 900 ;
+                in[AUDIO_IN_CHANNELS * i + chan[s]] = code ;
+                x[s][i] = code - 2048 ;
+            }
+            in[AUDIO_IN_CHANNELS * i + ADC_CHAN_1] = 2048 ;
+        }
+
+        uint64_t start = bench_cycles() ;
+        host_hal_run_block(in, out) ;
+        r->fixed_cycles += bench_cycles() - start ;
+
+        float mix[2][AUDIO_BLOCK_SIZE] = {{0}} ;
+        start = bench_cycles() ;
+        for (int ear = 0; ear < 2; ear++) {
+            for (int s = 0; s < 2; s++) {
+                const azimuth_cue *cue = &azimuth_table[azimuth[s]] ;
+                float gain = (float)cue->gain[ear] * level[s] / (32768.0f * 32768.0f) ;
+                float_voice_block(&ref[ear][s], gain, cue->delay[ear] / 32768.0f, x[s], mix[ear]) ;
+            }
+        }
+        r->float_cycles += bench_cycles() - start ;
+
+        // The reference truncated to DAC codes like the engine's packing
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            for (int ear = 0; ear < 2; ear++) {
+                double y = floor(mix[ear][i]) + 2048 ;
+                if (y < 0) y = 0 ;
+                if (y > 4095) y = 4095 ;
+                int e = abs((int)(out[AUDIO_OUT_CHANNELS * i + ear] & 0xfff) - (int)y) ;
+                r->err2 += (double)e * e ;
+                if (e > r->worst) r->worst = e ;
+                r->histogram[e <= FIXED_BOUND ? e : FIXED_BOUND + 1]++ ;
+            }
+        }
+    }
+}
+
+static void bench_fixed(void) {
+    fixed_result r, best = {0} ;
+    long samples = 2L * FIXED_BLOCKS * AUDIO_BLOCK_SIZE ;
+
+    // The error tallies repeat exactly; the cycle counts are best of
+    for (int t = 0; t < FIXED_TRIALS; t++) {
+        fixed_run(&r) ;
+        if (t == 0 || r.fixed_cycles < best.fixed_cycles) best.fixed_cycles = r.fixed_cycles ;
+        if (t == 0 || r.float_cycles < best.float_cycles) best.float_cycles = r.float_cycles ;
+    }
+
+    printf("fixed: ild/itd, 2 voices, %d random moves, q15 engine against a float reference\n",
+           FIXED_BLOCKS / FIXED_MOVE_EVERY) ;
+    printf("  error   max %d codes, RMS %.3f: %.1f%% bit-exact, %.1f%% within 1 (bound %d: %s)\n",
+           r.worst, sqrt(r.err2 / samples), 100.0 * r.histogram[0] / samples,
+           100.0 * (r.histogram[0] + r.histogram[1]) / samples, FIXED_BOUND,
+           r.worst <= FIXED_BOUND ? "ok" : "EXCEEDED") ;
+    if (r.worst > FIXED_BOUND) bench_failed = 1 ;
+    printf("  host    q15 %.2f, float %.2f %s per stereo sample, best of %d (%.2fx, with an FPU)\n",
+           (double)best.fixed_cycles / (samples / 2), (double)best.float_cycles / (samples / 2), BENCH_UNIT,
+           FIXED_TRIALS, (double)best.float_cycles / best.fixed_cycles) ;
+    printf("  M0+     float %.0f, fix15 64-bit %.0f, q15 %.0f cycles per voice per ear sample"
+           " (model): %.1fx over float\n",
+           M0_CYCLES_FLOAT_VOICE, M0_CYCLES_FIX15_VOICE, M0_CYCLES_Q15_VOICE,
+           M0_CYCLES_FLOAT_VOICE / M0_CYCLES_Q15_VOICE) ;
+
+    spatial_set_azimuth(SOURCE_R, 45, float2fix15(0.5)) ;
+    spatial_set_azimuth(SOURCE_L, 315, float2fix15(0.5)) ;
+}
+
+//========================================================================
+// Localization cues per direction state against the head model
+//========================================================================
+
+#define CUES_AMPLITUDE      1500        // test signal peak, ADC codes
+#define CUES_IMPULSES       16          // one every CUES_IMPULSE_EVERY samples
+#define CUES_IMPULSE_EVERY  256
+#define CUES_SWEEP_SAMPLES  AUDIO_SAMPLE_RATE           // 1 s, 100 Hz to 12 kHz
+#define CUES_SPEECH_SAMPLES (3 * AUDIO_SAMPLE_RATE)     // first 3 s of clip 0
+#define CUES_TAIL           (2 * AUDIO_BLOCK_SIZE)      // lets the late ear finish
+#define CUES_MAX_SAMPLES    (CUES_SPEECH_SAMPLES + CUES_TAIL)
+#define CUES_MAX_LAG        48          // ITD search range, samples (1.2 ms)
+
+// Largest ITD error (us) in either mode, under half a sample
+#define CUES_ITD_TOLERANCE  10.0
+
+enum { CUES_IMPULSE, CUES_SWEEP, CUES_SPEECH, CUES_SIGNALS } ;
+
+static const char *cues_signal_names[] = {"impulses", "sweep", "speech"} ;
+static const char *cues_mode_names[] = {"ild/itd", "hrtf"} ;
+
+// Interaural cues: ILD in dB (positive when the right ear is louder),
+// ITD in us (positive when the left ear lags)
+typedef struct {
+    double ild ;
+    double itd ;
+} cues ;
+
+// How far the measured ILD (dB) may stray from the expected one, below
+// and above it in the direction of the louder ear
+typedef struct {
+    double below ;
+    double above ;
+} cues_tolerance ;
+
+// ILD/ITD mode against the head model, per signal. The far ear's
+// fractional delay is read by interpolation, which loses high end: a
+// linear interpolator keeps between half and all of a white signal's
+// energy, so broadband impulses may gain up to 3 dB of ILD; the sweep
+// (to 12 kHz) less, speech (mostly under 4 kHz) next to none.
+static const cues_tolerance cues_model_tolerance[CUES_SIGNALS] = {
+    {0.10, 3.11},       // impulses
+    {0.25, 0.75},       // sweep
+    {0.25, 0.25},       // speech
+} ;
+
+// HRTF mode against the same HRIRs in float: fixed-point error only
+#define CUES_HRTF_ILD_TOLERANCE 0.25    // dB
+
+// Azimuths and levels of the direction states (spatial_audio.c)
+static const int cues_azimuth[5] = {80, 45, 0, 315, 280} ;
+static const double cues_level[5] = {0.1, 0.5, 0.5, 0.5, 0.1} ;
+
+// Head model cues of a direction state's azimuth (gen_azimuth_table.py)
+static cues cues_model(int state) {
+    double phi = asin(sin(cues_azimuth[state] * M_PI / 180)) ;
+    double lateral = fabs(phi), sign = (phi < 0) ? -1 : 1 ;
+    cues c = {
+        sign * 6.0 * sin(lateral),
+        sign * 1e6 * head_radius / speed_sound * (lateral + sin(lateral)),
+    } ;
+    return c ;
+}
+
+// Length of a test signal, in samples
+static long cues_length(int signal) {
+    switch (signal) {
+    case CUES_IMPULSE: return CUES_IMPULSES * CUES_IMPULSE_EVERY ;
+    case CUES_SWEEP:   return CUES_SWEEP_SAMPLES ;
+    default:           return audio_assets[0].frames < CUES_SPEECH_SAMPLES ?
+                              (long)audio_assets[0].frames : CUES_SPEECH_SAMPLES ;
+    }
+}
+
+// Sample n of a test signal, in ADC codes centred on zero
+static int cues_input(int signal, long n) {
+    if (signal == CUES_IMPULSE) return (n % CUES_IMPULSE_EVERY == 0) ? CUES_AMPLITUDE : 0 ;
+    if (signal == CUES_SWEEP) {
+        // Exponential sweep: equal time per octave
+        double t = (double)n / AUDIO_SAMPLE_RATE, span = (double)CUES_SWEEP_SAMPLES / AUDIO_SAMPLE_RATE ;
+        double k = log(12000.0 / 100.0) ;
+        return (int)lround(CUES_AMPLITUDE * sin(2 * M_PI * 100.0 * span / k * (exp(t * k / span) - 1))) ;
+    }
+    // harvard.wav, through the flash clip the packer made of it
+    return mulaw_decode_table[audio_assets[0].data[n]] >> 4 ;
+}
+
+// Cues of a pair of ear signals: ILD from the energy ratio, ITD from
+// the peak of the interaural cross-correlation (parabolic fit)
+static cues cues_estimate(const float *left, const float *right, long total) {
+    double el = 0, er = 0 ;
+    for (long n = 0; n < total; n++) {
+        el += (double)left[n] * left[n] ;
+        er += (double)right[n] * right[n] ;
+    }
+
+    // xc[k]: left against right shifted k samples later
+    double xc[2 * CUES_MAX_LAG + 1] ;
+    int peak = 0 ;
+    for (int k = -CUES_MAX_LAG; k <= CUES_MAX_LAG; k++) {
+        double acc = 0 ;
+        for (long n = CUES_MAX_LAG; n < total - CUES_MAX_LAG; n++) acc += (double)left[n] * right[n - k] ;
+        xc[k + CUES_MAX_LAG] = acc ;
+        if (acc > xc[peak]) peak = k + CUES_MAX_LAG ;
+    }
+    double lag = peak - CUES_MAX_LAG ;
+    if (peak > 0 && peak < 2 * CUES_MAX_LAG) {
+        double a = xc[peak - 1], b = xc[peak], c = xc[peak + 1] ;
+        if (a - 2 * b + c < 0) lag += 0.5 * (a - c) / (a - 2 * b + c) ;
+    }
+
+    cues m = {10 * log10(er / el), 1e6 * lag / AUDIO_SAMPLE_RATE} ;
+    return m ;
+}
+
+static float cues_ear[2][CUES_MAX_SAMPLES] ;
+
+// Play a test signal into ADC 2 with SOURCE_R at a direction state and
+// measure the cues at the two ears
+static cues cues_measure(int state, int signal) {
+    static uint16_t in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+    static uint16_t out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+    float (*ear)[CUES_MAX_SAMPLES] = cues_ear ;
+    long length = cues_length(signal) ;
+    long total = length + CUES_TAIL ;
+
+    spatial_set_direction_state(SOURCE_R, state) ;
+
+    // Only ADC 2 carries the signal; the other inputs stay silent
+    run_silence(host_hal_run_block) ;
+    for (int i = 0; i < AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS; i++) in[i] = 2048 ;
+
+    for (long n = 0; n < total; n += AUDIO_BLOCK_SIZE) {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            int x = (n + i < length) ? cues_input(signal, n + i) : 0 ;
+            in[AUDIO_IN_CHANNELS * i + ADC_CHAN_2] = 2048 + x ;
+        }
+        host_hal_run_block(in, out) ;
+        for (int i = 0; i < AUDIO_BLOCK_SIZE && n + i < total; i++) {
+            for (int e = 0; e < 2; e++) {
+                ear[e][n + i] = (float)((out[AUDIO_OUT_CHANNELS * i + e] & 0xfff) - 2048) ;
+            }
+        }
+    }
+
+    return cues_estimate(ear[EAR_LEFT], ear[EAR_RIGHT], total) ;
+}
+
+// Expected HRTF cues: the test signal through the state's HRIR pair in
+// float (the HRIRs are the head model in this mode) at the state's level,
+// clipped like the 12-bit output, measured the same way
+static cues cues_hrtf_expected(int state, int signal) {
+    long length = cues_length(signal) ;
+    long total = length + CUES_TAIL ;
+    int index = ((cues_azimuth[state] + HRIR_AZIMUTH_STEP / 2) / HRIR_AZIMUTH_STEP) % HRIR_AZIMUTHS ;
+    for (int e = 0; e < 2; e++) {
+        // The table is time reversed: its last tap meets the newest sample
+        const int16_t *h = hrir_table[index][e] ;
+        for (long n = 0; n < total; n++) {
+            double acc = 0 ;
+            for (int k = 0; k < HRIR_TAPS && k <= n; k++) {
+                if (n - k < length) acc += h[HRIR_TAPS - 1 - k] * (double)cues_input(signal, n - k) ;
+            }
+            double y = cues_level[state] * acc / (1 << HRIR_FRAC_BITS) ;
+            cues_ear[e][n] = (float)(y > 2047 ? 2047 : y < -2048 ? -2048 : y) ;
+        }
+    }
+    return cues_estimate(cues_ear[EAR_LEFT], cues_ear[EAR_RIGHT], total) ;
+}
+
+static void bench_cues(void) {
+    int failures = 0 ;
+
+    if (AUDIO_ASSET_COUNT == 0) {
+        printf("cues: needs clip 0 (harvard.wav) for the speech signal\n") ;
+        bench_failed = 1 ;
+        return ;
+    }
+    attach_engine() ;
+    spatial_set_ramp(1) ;
+
+    printf("cues: SOURCE_R alone at each direction state, ILD dB (right louder +),"
+           " ITD us (left lags +)\n") ;
+    printf("  expected in ( ): ild/itd from the head model, hrtf from its HRIRs in float;"
+           " ITD within %.0f us\n", CUES_ITD_TOLERANCE) ;
+    printf("  head model") ;
+    for (int state = 0; state < 5; state++) {
+        cues c = cues_model(state) ;
+        printf("   %d: %+.2f %+.0f", state, c.ild, c.itd) ;
+    }
+    printf("\n") ;
+
+    for (int mode = SPATIAL_MODE_ILD_ITD; mode <= SPATIAL_MODE_HRTF; mode++) {
+        spatial_set_mode(mode) ;
+        for (int signal = 0; signal < CUES_SIGNALS; signal++) {
+            for (int state = 0; state < 5; state++) {
+                cues m = cues_measure(state, signal) ;
+                cues g ;
+                cues_tolerance t ;
+                if (mode == SPATIAL_MODE_HRTF) {
+                    g = cues_hrtf_expected(state, signal) ;
+                    t = (cues_tolerance){CUES_HRTF_ILD_TOLERANCE, CUES_HRTF_ILD_TOLERANCE} ;
+                } else {
+                    g = cues_model(state) ;
+                    t = cues_model_tolerance[signal] ;
+                }
+                // ILD error towards the louder ear (state 2: either way)
+                double excess = (g.ild < 0) ? g.ild - m.ild : m.ild - g.ild ;
+                if (g.ild == 0) excess = fabs(excess) ;
+                int ok = excess >= -t.below && excess <= t.above && fabs(m.itd - g.itd) <= CUES_ITD_TOLERANCE ;
+                printf("  %-8s %-9s %d  ILD %+6.2f (%+6.2f)  ITD %+7.1f (%+7.1f)  %s\n",
+                       cues_mode_names[mode], cues_signal_names[signal], state,
+                       m.ild, g.ild, m.itd, g.itd, ok ? "ok" : "FAIL") ;
+                if (!ok) failures++ ;
+            }
+        }
+    }
+    printf("  %d of %d checks failed\n", failures, 2 * CUES_SIGNALS * 5) ;
+    if (failures) bench_failed = 1 ;
+
+    spatial_set_mode(SPATIAL_MODE_ILD_ITD) ;
+    spatial_set_azimuth(SOURCE_R, 45, float2fix15(0.5)) ;
+}
+
+//========================================================================
+// Benchmark table
+//========================================================================
+
+static const struct {
+    const char *name ;
+    void (*run)(void) ;
+} benches[] = {
+    {"delay", bench_delay},
+    {"engine", bench_engine},
+    {"click", bench_click},
+    {"hrtf", bench_hrtf},
+    {"voices", bench_voices},
+    {"clip", bench_clip},
+    {"resample", bench_resample},
+    {"profile", bench_profile},
+    {"fixed", bench_fixed},
+    {"cues", bench_cues},
+    {"stereo", bench_stereo},
+} ;
+
+int main(int argc, char **argv) {
+    int nbench = sizeof(benches) / sizeof(benches[0]) ;
+
+    // A misspelt name would otherwise run nothing and pass
+    for (int a = 1; a < argc; a++) {
+        int known = 0 ;
+        for (int i = 0; i < nbench; i++) {
+            if (!strcmp(argv[a], benches[i].name)) known = 1 ;
+        }
+        if (!known) {
+            fprintf(stderr, "unknown bench: %s (one of:", argv[a]) ;
+            for (int i = 0; i < nbench; i++) fprintf(stderr, " %s", benches[i].name) ;
+            fprintf(stderr, ")\n") ;
+            return 2 ;
+        }
+    }
+
+    for (int i = 0; i < nbench; i++) {
+        int selected = (argc < 2) ;
+        for (int a = 1; a < argc; a++) {
+            if (!strcmp(argv[a], benches[i].name)) selected = 1 ;
+        }
+        if (selected) benches[i].run() ;
+    }
+    return bench_failed ;
+}
@@ -0,0 +1,183 @@
+/**
+ * Offline renderer for the spatial audio engine
+ *
+ * Plays a WAV file "into the ADC" at the engine sample rate (converted
+ * with resampler.h from whatever rate the file has), runs the
+ * same block handlers the Pico runs (core 0 then core 1 for every
+ * block), and records DAC channels A (left ear) and B (right ear) into
+ * a stereo WAV.
+ *
+ * The left input channel feeds ADC 0 and the right feeds ADC 2, the
+ * way the audio player is wired to the board. A mono file feeds both.
+ *
+ * usage: spatial_render [-H] [-1] [-q tier] [-j zone] [-r state] [-l state] [-R deg] [-L deg]
+ *                       [-A deg] [-a clip] [-m] in.wav out.wav
+ *      -H  HRTF mode (default: ILD/ITD)
+ *      -1  both ears in one handler (spatial_block_stereo), as with
+ *          SPATIAL_ONE_CORE
+ *      -q  resampler quality 0-3 (linear, fast, medium, best; default medium)
+ *      -j  joystick zone 0-4, mapped exactly like the joystick thread
+ *      -r  direction state 0-4 of the right source (ADC 2)
+ *      -l  direction state 0-4 of the left source (ADC 0)
+ *      -R  azimuth in degrees of the right source, at level 0.5
+ *      -L  azimuth in degrees of the left source, at level 0.5
+ *      -A  azimuth in degrees for the following -a (default 0)
+ *      -a  also play flash clip n (audio_assets.h) at level 0.5, once
+ *      -m  mute the ADC inputs (free the SOURCE_R/SOURCE_L voices)
+ *
+ * The output lasts as long as in.wav.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "audio_hal.h"
+#include "spatial_audio.h"
+#include "host_hal.h"
+#include "resampler.h"
+#include "audio_assets.h"
+#include "wav.h"
+
+// Left and right input channels, converted to the engine rate
+static resampler input_rate[2] ;
+
+// Next input frame to hand each converter
+static long input_next[2] ;
+
+// One block of one input channel at the engine rate (silence past the end)
+static void input_block(const wav_t *in, int chan, int16_t *out) {
+    resampler *r = &input_rate[chan] ;
+    int src = (chan < in->channels) ? chan : in->channels - 1 ;
+    int16_t buf[RESAMPLER_BUFFER] ;
+    int n = resampler_input_needed(r, AUDIO_BLOCK_SIZE) ;
+
+    for (int i = 0; i < n; i++, input_next[chan]++) {
+        buf[i] = (input_next[chan] < in->frames) ? in->samples[input_next[chan] * in->channels + src] : 0 ;
+    }
+    resampler_write(r, buf, n) ;
+    resampler_read(r, out, AUDIO_BLOCK_SIZE) ;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: spatial_render [-H] [-1] [-q tier] [-j zone] [-r state] [-l state] "
+                    "[-R deg] [-L deg] [-A deg] [-a clip] [-m] in.wav out.wav\n") ;
+    exit(2) ;
+}
+
+int main(int argc, char **argv) {
+    wav_t in, out ;
+    int opt, clip_azimuth = 0, quality = RESAMPLER_MEDIUM, one_core = 0 ;
+
+    while ((opt = getopt(argc, argv, "H1q:j:r:l:R:L:A:a:m")) != -1) {
+        switch (opt) {
+        case 'H':
+            spatial_set_mode(SPATIAL_MODE_HRTF) ;
+            break ;
+        case '1':
+            one_core = 1 ;
+            break ;
+        case 'q':
+            quality = atoi(optarg) ;
+            break ;
+        case 'j':
+            spatial_set_direction(atoi(optarg)) ;
+            break ;
+        case 'r':
+            spatial_set_direction_state(SOURCE_R, atoi(optarg)) ;
+            break ;
+        case 'l':
+            spatial_set_direction_state(SOURCE_L, atoi(optarg)) ;
+            break ;
+        case 'R':
+            spatial_set_azimuth(SOURCE_R, atoi(optarg), float2fix15(0.5)) ;
+            break ;
+        case 'L':
+            spatial_set_azimuth(SOURCE_L, atoi(optarg), float2fix15(0.5)) ;
+            break ;
+        case 'A':
+            clip_azimuth = atoi(optarg) ;
+            break ;
+        case 'a':
+            if (atoi(optarg) < 0 || atoi(optarg) >= AUDIO_ASSET_COUNT) {
+                fprintf(stderr, "no clip %s (%d in audio_assets.h)\n", optarg, AUDIO_ASSET_COUNT) ;
+                return 2 ;
+            }
+            if (spatial_voice_play(&audio_assets[atoi(optarg)], 0, clip_azimuth, float2fix15(0.5)) < 0) {
+                fprintf(stderr, "out of voices\n") ;
+                return 2 ;
+            }
+            break ;
+        case 'm':
+            spatial_voice_free(SOURCE_R) ;
+            spatial_voice_free(SOURCE_L) ;
+            break ;
+        default:
+            usage() ;
+        }
+    }
+    if (argc - optind != 2) usage() ;
+
+    if (wav_read(argv[optind], &in)) return 1 ;
+
+    for (int c = 0; c < 2; c++) {
+        if (!resampler_init(&input_rate[c], in.sample_rate, AUDIO_SAMPLE_RATE, quality)) {
+            fprintf(stderr, "can't resample %d Hz to %d Hz at quality %d\n",
+                    in.sample_rate, AUDIO_SAMPLE_RATE, quality) ;
+            return 2 ;
+        }
+    }
+
+    // Output runs at the engine rate for the same duration as the input
+    out.channels = 2 ;
+    out.sample_rate = AUDIO_SAMPLE_RATE ;
+    out.frames = (long)((double)in.frames * AUDIO_SAMPLE_RATE / in.sample_rate) ;
+    out.samples = malloc(out.frames * 2 * sizeof(int16_t)) ;
+    if (out.samples == NULL) return 1 ;
+
+    // Attach the handlers the same way final.c does on each core
+    audio_hal_init() ;
+    if (one_core) {
+        audio_hal_attach(spatial_block_stereo) ;
+    }
+    else {
+        audio_hal_attach(spatial_block_core_0) ;
+        audio_hal_attach(spatial_block_core_1) ;
+    }
+
+    clock_t start = clock() ;
+
+    for (long base = 0; base < out.frames; base += AUDIO_BLOCK_SIZE) {
+        uint16_t block_in[AUDIO_BLOCK_SIZE * AUDIO_IN_CHANNELS] ;
+        uint16_t __attribute__((aligned(4))) block_out[AUDIO_BLOCK_SIZE * AUDIO_OUT_CHANNELS] ;
+        int16_t left[AUDIO_BLOCK_SIZE], right[AUDIO_BLOCK_SIZE] ;
+
+        // Fill one input block
+        input_block(&in, 0, left) ;
+        input_block(&in, 1, right) ;
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            uint16_t *frame = &block_in[AUDIO_IN_CHANNELS * i] ;
+            frame[ADC_CHAN_0] = pcm_to_adc12(left[i]) ;
+            frame[ADC_CHAN_1] = 2048 ;
+            frame[ADC_CHAN_2] = pcm_to_adc12(right[i]) ;
+        }
+
+        host_hal_run_block(block_in, block_out) ;
+
+        for (int i = 0; i < AUDIO_BLOCK_SIZE && base + i < out.frames; i++) {
+            out.samples[2 * (base + i)]     = dac12_to_pcm(block_out[AUDIO_OUT_CHANNELS * i] & 0xfff) ;
+            out.samples[2 * (base + i) + 1] = dac12_to_pcm(block_out[AUDIO_OUT_CHANNELS * i + 1] & 0xfff) ;
+        }
+    }
+
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC ;
+    printf("%ld samples in %.3f s (%.1f ns/sample, %.0fx real time)\n",
+           out.frames, seconds, 1e9 * seconds / out.frames,
+           out.frames / (seconds * AUDIO_SAMPLE_RATE)) ;
+
+    int err = wav_write(argv[optind + 1], &out) ;
+    wav_free(&in) ;
+    wav_free(&out) ;
+    return err ? 1 : 0 ;
+}
@@ -0,0 +1,570 @@
+/**
+ * Host benchmarks for the VGA drawing primitives (vga_raster.c)
+ *
+ * usage: vga_bench [name ...]
+ *
+ * With no arguments every benchmark runs. Each one draws the same
+ * shapes with the per-pixel reference below (how the primitives worked
+ * before they filled spans) and with the library, prints pixels per
+ * second for both, and checks that the two framebuffers are identical.
+ * "damage" instead animates a retained scene and compares redrawing
+ * only the damaged rectangles with redrawing the whole screen, frame by
+ * frame. "tiles" composes a tile map and sprites a line at a time, as
+ * the scanline mode does, against drawing them pixel by pixel. "edges"
+ * draws shapes off every edge of the screen, which must leave it black.
+ * The exit status is 1 if any framebuffers differ.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vga_graphics.h"
+#include "vga_raster.h"
+#include "vga_tiles.h"
+#include "bench.h"
+// Font file (for the reference drawChar)
+#include "glcdfont.c"
+
+#define VGA_TRIALS 5
+
+// Set when the library and the reference draw different pixels
+static int bench_failed ;
+
+//========================================================================
+// Per-pixel reference (drawPixel for every pixel, column by column)
+//========================================================================
+
+static void ref_fill_rect(short x, short y, short w, short h, char color) {
+    for (int i = x; i < (x + w); i++) {
+        for (int j = y; j < (y + h); j++) {
+            drawPixel(i, j, color) ;
+        }
+    }
+}
+
+static void ref_hline(short x, short y, short w, char color) {
+    for (short i = x; i < (x + w); i++) {
+        drawPixel(i, y, color) ;
+    }
+}
+
+static void ref_draw_char(short x, short y, unsigned char c, char color, char bg, unsigned char size) {
+    for (int i = 0; i < 6; i++) {
+        unsigned char line = (i == 5) ? 0 : font[c * 5 + i] ;
+        for (int j = 0; j < 8; j++) {
+            char pen = (line & 1) ? color : bg ;
+            if ((line & 1) || bg != color) {
+                if (size == 1) drawPixel(x + i, y + j, pen) ;
+                else ref_fill_rect(x + i * size, y + j * size, size, size, pen) ;
+            }
+            line >>= 1 ;
+        }
+    }
+}
+
+//========================================================================
+// Harness
+//========================================================================
+
+// Something to draw: reference or library, and the pixels it covers
+typedef struct {
+    const char *name ;
+    void (*draw)(int ref) ;
+    double pixels ;
+} vga_case ;
+
+static unsigned char reference[VGA_BYTES] ;
+
+// Best-of-trials host cycles of one draw, from a cleared framebuffer
+static double vga_time(const vga_case *c, int ref) {
+    double best = 0 ;
+    for (int t = 0; t < VGA_TRIALS; t++) {
+        memset(vga_data_array, 0, VGA_BYTES) ;
+        uint64_t start = bench_cycles() ;
+        c->draw(ref) ;
+        double cycles = (double)(bench_cycles() - start) ;
+        bench_keep(vga_data_array[VGA_BYTES / 2]) ;
+        if (t == 0 || cycles < best) best = cycles ;
+    }
+    return best ;
+}
+
+static void vga_run(const vga_case *c) {
+    double ref = vga_time(c, 1) ;
+    memcpy(reference, vga_data_array, VGA_BYTES) ;
+    double lib = vga_time(c, 0) ;
+    int same = !memcmp(reference, vga_data_array, VGA_BYTES) ;
+    if (!same) bench_failed = 1 ;
+
+    printf("  %-14s %12.0f %12.0f %9.0f %9.0f %7.1fx  %s\n", c->name, ref, lib,
+           1000 * c->pixels / ref, 1000 * c->pixels / lib, ref / lib, same ? "same" : "DIFFERENT") ;
+}
+
+static void vga_header(const char *what) {
+    printf("%s: host %s per draw, then pixels per 1000 %s\n", what, BENCH_UNIT, BENCH_UNIT) ;
+    printf("  %-14s %12s %12s %9s %9s %8s\n", "", "per-pixel", "spans", "per-pixel", "spans", "speedup") ;
+}
+
+//========================================================================
+// Full-screen clears
+//========================================================================
+
+static void draw_clear(int ref) {
+    for (char color = 1; color <= 4; color++) {
+        if (ref) ref_fill_rect(0, 0, 640, 480, color) ;
+        else fillRect(0, 0, 640, 480, color) ;
+    }
+}
+
+// A screen of 16x16 tiles, odd offsets so every edge case is hit
+static void draw_tiles(int ref) {
+    for (int y = 3; y < 480 - 16; y += 19) {
+        for (int x = 1; x < 640 - 16; x += 17) {
+            if (ref) ref_fill_rect(x, y, 15 + (x & 1), 16, (x + y) & 7) ;
+            else fillRect(x, y, 15 + (x & 1), 16, (x + y) & 7) ;
+        }
+    }
+}
+
+static void bench_clear(void) {
+    vga_case cases[] = {
+        {"clear x4", draw_clear, 4.0 * 640 * 480},
+        {"16x16 rects", draw_tiles, 0},
+    } ;
+    for (int y = 3; y < 480 - 16; y += 19) {
+        for (int x = 1; x < 640 - 16; x += 17) cases[1].pixels += (15 + (x & 1)) * 16 ;
+    }
+    vga_header("fillRect") ;
+    for (int i = 0; i < 2; i++) vga_run(&cases[i]) ;
+}
+
+//========================================================================
+// Horizontal lines
+//========================================================================
+
+#define HLINES 20000
+
+static short hline_x[HLINES], hline_y[HLINES], hline_w[HLINES] ;
+
+static void draw_hlines(int ref) {
+    for (int i = 0; i < HLINES; i++) {
+        if (ref) ref_hline(hline_x[i], hline_y[i], hline_w[i], i & 7) ;
+        else drawHLine(hline_x[i], hline_y[i], hline_w[i], i & 7) ;
+    }
+}
+
+static void bench_hline(void) {
+    vga_case c = {"random", draw_hlines, 0} ;
+    uint32_t seed = 1 ;
+    for (int i = 0; i < HLINES; i++) {
+        hline_w[i] = 1 + bench_rand(&seed) % 200 ;
+        hline_x[i] = bench_rand(&seed) % (640 - hline_w[i]) ;
+        hline_y[i] = bench_rand(&seed) % 480 ;
+        c.pixels += hline_w[i] ;
+    }
+    vga_header("drawHLine") ;
+    vga_run(&c) ;
+}
+
+//========================================================================
+// Text
+//========================================================================
+
+static const char text_line[] = "Who was in the library at midnight?" ;
+
+static unsigned char text_size ;
+
+// Lines of text down the screen, on a background
+static void draw_text(int ref) {
+    int len = sizeof(text_line) - 1 ;
+    for (int y = 0; y + 8 * text_size <= 480; y += 8 * text_size) {
+        for (int k = 0; k < len && (k + 1) * 6 * text_size <= 640; k++) {
+            if (ref) ref_draw_char(k * 6 * text_size, y, text_line[k], WHITE, BLUE, text_size) ;
+            else drawChar(k * 6 * text_size, y, text_line[k], WHITE, BLUE, text_size) ;
+        }
+    }
+}
+
+// writeString's layout (wrapping at the right edge) over ref_draw_char
+static void ref_write_string(short x, short y, const char *str, char color, char bg, unsigned char size) {
+    for (; *str; str++) {
+        ref_draw_char(x, y, *str, color, bg, size) ;
+        x += 6 * size ;
+        if (x > 640 - 6 * size) {
+            x = 0 ;
+            y += 8 * size ;
+        }
+    }
+}
+
+// A page of dialogue starting at an odd x, opaque then transparent
+static char page[4096] ;
+static int page_chars ;
+
+static void draw_page(int ref) {
+    if (ref) {
+        ref_write_string(3, 1, page, WHITE, BLUE, text_size) ;
+        ref_write_string(1, 240, page, YELLOW, YELLOW, text_size) ;
+        return ;
+    }
+    setTextWrap(1) ;
+    setTextSize(text_size) ;
+    setCursor(3, 1) ;
+    setTextColor2(WHITE, BLUE) ;
+    writeString(page) ;
+    setCursor(1, 240) ;
+    setTextColor(YELLOW) ;
+    writeString(page) ;
+}
+
+// Characters per second of the page at each size, reference and library
+static void text_rates(void) {
+    printf("writeString: characters per second (host)\n") ;
+    printf("  %-14s %12s %12s %8s\n", "", "per-pixel", "glyphs", "speedup") ;
+    for (text_size = 1; text_size <= 5; text_size++) {
+        // Half a screen of text at this size, less the partial last line
+        int per_line = 640 / (6 * text_size) ;
+        int lines = 240 / (8 * text_size) - 1 ;
+        int len = sizeof(text_line) - 1 ;
+        page_chars = per_line * lines - 1 ;
+        for (int i = 0; i < page_chars; i++) page[i] = text_line[i % len] ;
+        page[page_chars] = 0 ;
+
+        double rate[2] ;
+        for (int ref = 1; ref >= 0; ref--) {
+            double best = 0 ;
+            for (int t = 0; t < VGA_TRIALS; t++) {
+                memset(vga_data_array, 0, VGA_BYTES) ;
+                double start = bench_seconds() ;
+                draw_page(ref) ;
+                double seconds = bench_seconds() - start ;
+                if (t == 0 || seconds < best) best = seconds ;
+            }
+            rate[ref] = 2 * page_chars / best ;
+            if (ref) memcpy(reference, vga_data_array, VGA_BYTES) ;
+        }
+        int same = !memcmp(reference, vga_data_array, VGA_BYTES) ;
+        if (!same) bench_failed = 1 ;
+        printf("  size %-9d %12.0f %12.0f %7.1fx  %s\n", text_size, rate[1], rate[0],
+               rate[0] / rate[1], same ? "same" : "DIFFERENT") ;
+    }
+}
+
+static void bench_text(void) {
+    vga_header("drawChar") ;
+    for (text_size = 1; text_size <= 3; text_size++) {
+        char name[16] ;
+        int len = sizeof(text_line) - 1 ;
+        int per_line = 640 / (6 * text_size) ;
+        int lines = 480 / (8 * text_size) ;
+        vga_case c = {name, draw_text, 0} ;
+        snprintf(name, sizeof(name), "size %d", text_size) ;
+        c.pixels = (double)lines * (len < per_line ? len : per_line) * 48 * text_size * text_size ;
+        vga_run(&c) ;
+    }
+    text_rates() ;
+}
+
+//========================================================================
+// Damage tracking: a map screen redrawn from its scene
+//========================================================================
+
+#define MAP_COLS 6
+#define MAP_ROWS 4
+#define MAP_CELL_W 106
+#define MAP_CELL_H 80
+#define DAMAGE_FRAMES 240
+
+typedef struct {
+    const char *name ;
+    char color ;
+} map_cell ;
+
+static const char *room_names[] = {"Hall", "Study", "Lounge", "Library", "Cellar", "Kitchen"} ;
+static map_cell cells[MAP_COLS * MAP_ROWS] ;
+static const char *dialog_text ;
+
+static void draw_label(short x, short y, const char *str, char color, char bg, unsigned char size) {
+    for (; *str; str++, x += 6 * size) drawChar(x, y, *str, color, bg, size) ;
+}
+
+static void draw_cell(short x, short y, short w, short h, void *arg) {
+    map_cell *c = arg ;
+    fillRoundRect(x + 2, y + 2, w - 4, h - 4, 6, c->color) ;
+    drawRoundRect(x + 2, y + 2, w - 4, h - 4, 6, WHITE) ;
+    draw_label(x + 8, y + 8, c->name, WHITE, c->color, 2) ;
+}
+
+static void draw_marker(short x, short y, short w, short h, void *arg) {
+    (void)arg ;
+    fillCircle(x + w / 2, y + h / 2, w / 2 - 1, YELLOW) ;
+    drawCircle(x + w / 2, y + h / 2, w / 2 - 1, BLACK) ;
+}
+
+static void draw_dialog(short x, short y, short w, short h, void *arg) {
+    (void)arg ;
+    fillRect(x, y, w, h, BLACK) ;
+    drawRect(x, y, w, h, WHITE) ;
+    draw_label(x + 8, y + 8, "Detective:", CYAN, BLACK, 1) ;
+    draw_label(x + 8, y + 24, dialog_text, WHITE, BLACK, 1) ;
+}
+
+static void bench_damage(void) {
+    static unsigned char incremental[VGA_BYTES] ;
+    static const char *lines[] = {
+        "Who was in the library at midnight?",
+        "The cellar door was locked from inside.",
+        "Someone moved the candlestick.",
+    } ;
+    double inc_cycles = 0, full_cycles = 0, damaged = 0 ;
+    int same = 1 ;
+
+    // Whatever is on screen goes; cells under the marker, the dialog on top
+    sceneSetBackground(BLACK) ;
+    for (int i = 0; i < MAP_COLS * MAP_ROWS; i++) {
+        cells[i] = (map_cell){room_names[i % 6], (char)(1 + i % 6)} ;
+        sceneAdd((i % MAP_COLS) * MAP_CELL_W + 2, 40 + (i / MAP_COLS) * MAP_CELL_H,
+                 MAP_CELL_W, MAP_CELL_H, draw_cell, &cells[i]) ;
+    }
+    short mx = 10, my = 60 ;
+    int marker = sceneAdd(mx, my, 24, 24, draw_marker, 0) ;
+    dialog_text = lines[0] ;
+    int dialog = sceneAdd(120, 380, 400, 48, draw_dialog, 0) ;
+    sceneRedraw() ;
+
+    for (int f = 0; f < DAMAGE_FRAMES; f++) {
+        // The marker walks across the map; a room is revealed now and
+        // then, and the dialog moves on
+        mx = (mx + 3) % (640 - 24) ;
+        if (f % 16 == 0) my = 60 + (f / 16) % MAP_ROWS * MAP_CELL_H ;
+        sceneMove(marker, mx, my, 24, 24) ;
+        if (f % 20 == 0) {
+            int c = (f / 20 * 7) % (MAP_COLS * MAP_ROWS) ;
+            cells[c].color = (cells[c].color & 7) == 7 ? 1 : cells[c].color + 1 ;
+            sceneInvalidate(c) ;
+        }
+        if (f % 60 == 0) {
+            dialog_text = lines[(f / 60) % 3] ;
+            sceneInvalidate(dialog) ;
+        }
+
+        for (int i = 0; i < damageCount(); i++) {
+            short x, y, w, h ;
+            getDamage(i, &x, &y, &w, &h) ;
+            damaged += (double)w * h ;
+        }
+        uint64_t start = bench_cycles() ;
+        sceneRedraw() ;
+        inc_cycles += (double)(bench_cycles() - start) ;
+        memcpy(incremental, vga_data_array, VGA_BYTES) ;
+
+        // The same frame drawn from scratch
+        memset(vga_data_array, 0, VGA_BYTES) ;
+        start = bench_cycles() ;
+        addDamage(0, 0, 640, 480) ;
+        sceneRedraw() ;
+        full_cycles += (double)(bench_cycles() - start) ;
+        if (memcmp(incremental, vga_data_array, VGA_BYTES)) same = 0 ;
+
+        // Carry on from the incremental frame
+        memcpy(vga_data_array, incremental, VGA_BYTES) ;
+    }
+    if (!same) bench_failed = 1 ;
+
+    // The caller's clip rectangle survives a redraw
+    short cx, cy, cw, ch ;
+    setClipRect(100, 50, 200, 120) ;
+    addDamage(0, 0, 640, 480) ;
+    sceneRedraw() ;
+    getClipRect(&cx, &cy, &cw, &ch) ;
+    int clip_kept = cx == 100 && cy == 50 && cw == 200 && ch == 120 ;
+    if (!clip_kept) bench_failed = 1 ;
+    clearClipRect() ;
+
+    // Dead ids (a full scene's -1, a removed item) add no damage
+    sceneRemove(marker) ;
+    sceneRedraw() ;
+    sceneMove(marker, 0, 0, 640, 480) ;
+    sceneInvalidate(marker) ;
+    sceneRemove(marker) ;
+    sceneMove(-1, 0, 0, 640, 480) ;
+    sceneInvalidate(VGA_SCENE_ITEMS) ;
+    int dead_ignored = damageCount() == 0 ;
+    if (!dead_ignored) bench_failed = 1 ;
+
+    printf("sceneRedraw: host %s per frame, %d frames\n", BENCH_UNIT, DAMAGE_FRAMES) ;
+    printf("  %-14s %12s %12s %9s %8s\n", "", "full", "damaged", "% redrawn", "speedup") ;
+    printf("  %-14s %12.0f %12.0f %8.1f%% %7.1fx  %s\n", "map scene", full_cycles / DAMAGE_FRAMES,
+           inc_cycles / DAMAGE_FRAMES, 100 * damaged / (640.0 * 480 * DAMAGE_FRAMES),
+           full_cycles / inc_cycles, same ? "same" : "DIFFERENT") ;
+    printf("  caller's clip rectangle %s\n", clip_kept ? "kept" : "LOST") ;
+    printf("  dead scene ids %s\n", dead_ignored ? "ignored" : "DAMAGE") ;
+}
+
+//========================================================================
+// Scanline tiles and sprites
+//========================================================================
+
+#define TILE_MAP_W 96
+#define TILE_MAP_H 64
+#define TILE_COUNT 16
+#define SPRITE_SIZE 16
+
+static unsigned char tile_set[TILE_COUNT][VGA_TILE_BYTES] __attribute__((aligned(4))) ;
+static unsigned char tile_map[TILE_MAP_H * TILE_MAP_W] ;
+static unsigned char sprite_pixels[SPRITE_SIZE * SPRITE_SIZE / 2] ;
+static short tile_scroll_x, tile_scroll_y ;
+static short tile_map_w, tile_map_h ;
+
+static char packed_pixel(const unsigned char *row, int i) {
+    return (row[i >> 1] >> ((i & 1) * 3)) & 7 ;
+}
+
+// Every screen pixel looked up in the map, then every sprite over it
+static void ref_tiles(void) {
+    for (int y = 0; y < 480; y++) {
+        int my = (y + tile_scroll_y) % (tile_map_h * 8) ;
+        for (int x = 0; x < 640; x++) {
+            int mx = (x + tile_scroll_x) % (tile_map_w * 8) ;
+            const unsigned char *tile = tile_set[tile_map[(my / 8) * tile_map_w + mx / 8]] ;
+            drawPixel(x, y, packed_pixel(&tile[(my % 8) * 4], mx % 8)) ;
+        }
+    }
+    for (int id = 0; id < VGA_SPRITES; id++) {
+        short sx = 40 * id - 8, sy = 29 * id - 8 ;
+        for (int j = 0; j < SPRITE_SIZE; j++) {
+            for (int i = 0; i < SPRITE_SIZE; i++) {
+                char color = packed_pixel(&sprite_pixels[j * SPRITE_SIZE / 2], i) ;
+                if (color == BLACK) continue ;
+                drawPixel(sx + i, sy + j, color) ;
+            }
+        }
+    }
+}
+
+static void draw_tile_frame(int ref) {
+    if (ref) {
+        ref_tiles() ;
+        return ;
+    }
+    setTileMap(tile_map, tile_map_w, tile_map_h, &tile_set[0][0]) ;
+    scrollTiles(tile_scroll_x, tile_scroll_y) ;
+    for (int y = 0; y < 480; y++) vga_tiles_line(y, &vga_data_array[y * 320]) ;
+}
+
+static void bench_tiles(void) {
+    uint32_t seed = 7 ;
+    for (int t = 0; t < TILE_COUNT; t++) {
+        for (int b = 0; b < VGA_TILE_BYTES; b++) tile_set[t][b] = bench_rand(&seed) & 0x3f ;
+    }
+    for (int i = 0; i < TILE_MAP_H * TILE_MAP_W; i++) tile_map[i] = bench_rand(&seed) % TILE_COUNT ;
+    // A ring, black (transparent) around and inside it
+    for (int j = 0; j < SPRITE_SIZE; j++) {
+        for (int i = 0; i < SPRITE_SIZE; i++) {
+            int d = (2 * i - 15) * (2 * i - 15) + (2 * j - 15) * (2 * j - 15) ;
+            char color = (d > 100 && d < 225) ? 1 + (i + j) % 7 : BLACK ;
+            sprite_pixels[(j * SPRITE_SIZE + i) >> 1] |= color << ((i & 1) * 3) ;
+        }
+    }
+    // Odd ids placed by moveSprite, so the reference checks it too
+    for (int id = 0; id < VGA_SPRITES; id++) {
+        if (id & 1) {
+            setSprite(id, 0, 0, SPRITE_SIZE, SPRITE_SIZE, sprite_pixels, BLACK) ;
+            moveSprite(id, 40 * id - 8, 29 * id - 8) ;
+        }
+        else setSprite(id, 40 * id - 8, 29 * id - 8, SPRITE_SIZE, SPRITE_SIZE, sprite_pixels, BLACK) ;
+    }
+
+    // Maps larger than the screen, and one that wraps several times
+    // each way (the rest of tile_map would show if it read past it)
+    static const struct {
+        const char *name ;
+        short x, y, map_w, map_h ;
+    } scrolls[] = {
+        {"scroll 0,0", 0, 0, TILE_MAP_W, TILE_MAP_H},
+        {"scroll 8,3", 8, 3, TILE_MAP_W, TILE_MAP_H},
+        {"scroll 6,500", 6, 500, TILE_MAP_W, TILE_MAP_H},
+        {"10x4 map", 6, 3, 10, 4},
+    } ;
+    vga_header("vga_tiles_line") ;
+    for (int i = 0; i < 4; i++) {
+        vga_case c = {scrolls[i].name, draw_tile_frame, 640.0 * 480} ;
+        tile_scroll_x = scrolls[i].x ;
+        tile_scroll_y = scrolls[i].y ;
+        tile_map_w = scrolls[i].map_w ;
+        tile_map_h = scrolls[i].map_h ;
+        vga_run(&c) ;
+    }
+    setTileMap(0, 0, 0, 0) ;
+    for (int id = 0; id < VGA_SPRITES; id++) setSprite(id, 0, 0, 0, 0, 0, BLACK) ;
+}
+
+//========================================================================
+// Shapes off the screen
+//========================================================================
+
+// Lines, circles and size-1 text just past each edge, which would smear
+// along it if pixels were clamped
+static void draw_off_screen(void) {
+    static const short x[4] = {-40, 660, 100, 300}, y[4] = {100, 300, -30, 500} ;
+    for (int e = 0; e < 4; e++) {
+        drawLine(x[e], y[e], x[e] + (e < 2 ? 10 : 300), y[e] + (e < 2 ? 300 : 15), WHITE) ;
+        drawCircle(x[e] + 10, y[e] + 10, 12, GREEN) ;
+        for (int i = 0; i < 4; i++) drawChar(x[e] + 6 * i, y[e], 'A' + i, RED, BLUE, 1) ;
+    }
+}
+
+// A check, not a timing: the framebuffer has to stay clear
+static void bench_edges(void) {
+    memset(vga_data_array, 0, VGA_BYTES) ;
+    memset(reference, 0, VGA_BYTES) ;
+    draw_off_screen() ;
+    int same = !memcmp(reference, vga_data_array, VGA_BYTES) ;
+    if (!same) bench_failed = 1 ;
+    printf("edges: shapes past each screen edge, against a clear screen\n") ;
+    printf("  %-14s %s\n", "off screen", same ? "same" : "DIFFERENT") ;
+}
+
+//========================================================================
+// Benchmark table
+//========================================================================
+
+static const struct {
+    const char *name ;
+    void (*run)(void) ;
+} benches[] = {
+    {"clear", bench_clear},
+    {"hline", bench_hline},
+    {"text", bench_text},
+    {"damage", bench_damage},
+    {"tiles", bench_tiles},
+    {"edges", bench_edges},
+} ;
+
+int main(int argc, char **argv) {
+    int nbench = sizeof(benches) / sizeof(benches[0]) ;
+
+    // A misspelt name would otherwise run nothing and pass
+    for (int a = 1; a < argc; a++) {
+        int known = 0 ;
+        for (int i = 0; i < nbench; i++) {
+            if (!strcmp(argv[a], benches[i].name)) known = 1 ;
+        }
+        if (!known) {
+            fprintf(stderr, "unknown bench: %s (one of:", argv[a]) ;
+            for (int i = 0; i < nbench; i++) fprintf(stderr, " %s", benches[i].name) ;
+            fprintf(stderr, ")\n") ;
+            return 2 ;
+        }
+    }
+
+    for (int i = 0; i < nbench; i++) {
+        int selected = (argc < 2) ;
+        for (int a = 1; a < argc; a++) {
+            if (!strcmp(argv[a], benches[i].name)) selected = 1 ;
+        }
+        if (selected) benches[i].run() ;
+    }
+    return bench_failed ;
+}
@@ -0,0 +1,120 @@
+/**
+ * Minimal RIFF/WAVE reader and writer for the host tools
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wav.h"
+
+static uint32_t get_u32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24) ;
+}
+
+static uint16_t get_u16(const unsigned char *p) {
+    return p[0] | (p[1] << 8) ;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    p[0] = v ; p[1] = v >> 8 ; p[2] = v >> 16 ; p[3] = v >> 24 ;
+}
+
+static void put_u16(unsigned char *p, uint16_t v) {
+    p[0] = v ; p[1] = v >> 8 ;
+}
+
+int wav_read(const char *path, wav_t *wav) {
+    unsigned char hdr[12], chunk[8], fmt[16] ;
+    int have_fmt = 0 ;
+    FILE *f = fopen(path, "rb") ;
+
+    memset(wav, 0, sizeof(*wav)) ;
+    if (f == NULL) {
+        fprintf(stderr, "wav: cannot open %s\n", path) ;
+        return -1 ;
+    }
+    if (fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        fprintf(stderr, "wav: %s is not a RIFF/WAVE file\n", path) ;
+        fclose(f) ;
+        return -1 ;
+    }
+
+    // Walk the chunk list until we have both "fmt " and "data"
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = get_u32(chunk + 4) ;
+        if (!memcmp(chunk, "fmt ", 4)) {
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) break ;
+            if (get_u16(fmt) != 1 || get_u16(fmt + 14) != 16) {
+                fprintf(stderr, "wav: %s is not 16-bit PCM\n", path) ;
+                break ;
+            }
+            wav->channels = get_u16(fmt + 2) ;
+            wav->sample_rate = get_u32(fmt + 4) ;
+            have_fmt = 1 ;
+            fseek(f, size - 16 + (size & 1), SEEK_CUR) ;
+        }
+        else if (!memcmp(chunk, "data", 4) && have_fmt) {
+            wav->frames = size / (2 * wav->channels) ;
+            wav->samples = malloc(wav->frames * wav->channels * sizeof(int16_t)) ;
+            if (wav->samples == NULL) break ;
+            unsigned char *raw = (unsigned char *)wav->samples ;
+            long n = fread(raw, 2, wav->frames * wav->channels, f) ;
+            wav->frames = n / wav->channels ;
+            // Byte-swap in place so this also works on big-endian hosts
+            for (long i = 0; i < n; i++) {
+                wav->samples[i] = (int16_t)get_u16(raw + 2 * i) ;
+            }
+            fclose(f) ;
+            return 0 ;
+        }
+        else {
+            fseek(f, size + (size & 1), SEEK_CUR) ;
+        }
+    }
+
+    fprintf(stderr, "wav: %s has no usable fmt/data chunks\n", path) ;
+    wav_free(wav) ;
+    fclose(f) ;
+    return -1 ;
+}
+
+int wav_write(const char *path, const wav_t *wav) {
+    unsigned char hdr[44] ;
+    uint32_t bytes = wav->frames * wav->channels * 2 ;
+    FILE *f = fopen(path, "wb") ;
+
+    if (f == NULL) {
+        fprintf(stderr, "wav: cannot create %s\n", path) ;
+        return -1 ;
+    }
+
+    memcpy(hdr, "RIFF", 4) ;
+    put_u32(hdr + 4, 36 + bytes) ;
+    memcpy(hdr + 8, "WAVEfmt ", 8) ;
+    put_u32(hdr + 16, 16) ;
+    put_u16(hdr + 20, 1) ;
+    put_u16(hdr + 22, wav->channels) ;
+    put_u32(hdr + 24, wav->sample_rate) ;
+    put_u32(hdr + 28, wav->sample_rate * wav->channels * 2) ;
+    put_u16(hdr + 32, wav->channels * 2) ;
+    put_u16(hdr + 34, 16) ;
+    memcpy(hdr + 36, "data", 4) ;
+    put_u32(hdr + 40, bytes) ;
+    fwrite(hdr, 1, 44, f) ;
+
+    for (long i = 0; i < wav->frames * wav->channels; i++) {
+        unsigned char s[2] ;
+        put_u16(s, (uint16_t)wav->samples[i]) ;
+        fwrite(s, 1, 2, f) ;
+    }
+
+    fclose(f) ;
+    return 0 ;
+}
+
+void wav_free(wav_t *wav) {
+    free(wav->samples) ;
+    wav->samples = NULL ;
+    wav->frames = 0 ;
+}
@@ -0,0 +1,28 @@
+/**
+ * Minimal RIFF/WAVE reader and writer for the host tools
+ *
+ * Only 16-bit PCM is supported. Samples are kept interleaved.
+ */
+
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdint.h>
+
+typedef struct {
+    int channels ;          // 1 = mono, 2 = stereo
+    int sample_rate ;       // frames per second
+    long frames ;           // number of frames (samples per channel)
+    int16_t *samples ;      // interleaved samples, frames*channels long
+} wav_t ;
+
+// Load a 16-bit PCM WAV file. Returns 0 on success.
+int wav_read(const char *path, wav_t *wav) ;
+
+// Write a 16-bit PCM WAV file. Returns 0 on success.
+int wav_write(const char *path, const wav_t *wav) ;
+
+// Release the sample buffer
+void wav_free(wav_t *wav) ;
+
+#endif
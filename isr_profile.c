@@ -0,0 +1,154 @@
+/**
+ * Cycle budget profiler for the audio block interrupts (see isr_profile.h)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "isr_profile.h"
+
+typedef struct {
+    atomic_uint seq ;           // odd while the owning core updates stats
+    atomic_bool reset ;         // clear at the next block
+    bool started ;              // last_entry is valid
+    uint32_t last_entry ;       // previous block's entry
+    uint32_t entry ;            // this block's entry
+    isr_profile_stats stats ;
+} core_profile ;
+
+static core_profile profile[ISR_PROFILE_CORES] ;
+
+static uint32_t budget ;
+static uint32_t ticks_per_us ;
+static uint32_t tick_mask ;
+
+static void clear_stats(isr_profile_stats *s) {
+    memset(s, 0, sizeof(*s)) ;
+    s->busy_min = UINT32_MAX ;
+    s->jitter_min = UINT32_MAX ;
+}
+
+static inline void histogram_add(uint32_t *hist, uint32_t ticks, uint32_t range) {
+    uint32_t b = (uint32_t)(((uint64_t)ticks * ISR_PROFILE_BUCKETS) / range) ;
+    hist[b < ISR_PROFILE_BUCKETS ? b : ISR_PROFILE_BUCKETS - 1]++ ;
+}
+
+void isr_profile_init(uint32_t budget_ticks, uint32_t rate, uint32_t mask) {
+    budget = budget_ticks ;
+    ticks_per_us = rate ? rate : 1 ;
+    tick_mask = mask ;
+    for (int c = 0; c < ISR_PROFILE_CORES; c++) {
+        profile[c].started = false ;
+        atomic_store(&profile[c].reset, false) ;
+        clear_stats(&profile[c].stats) ;
+    }
+}
+
+void isr_profile_enter(unsigned int core, uint32_t now) {
+    profile[core].entry = now ;
+}
+
+void isr_profile_exit(unsigned int core, uint32_t now) {
+    core_profile *p = &profile[core] ;
+    isr_profile_stats *s = &p->stats ;
+    uint32_t busy = (now - p->entry) & tick_mask ;
+
+    // Not set up (the host tools only profile on request)
+    if (budget == 0) return ;
+
+    unsigned int seq = atomic_load_explicit(&p->seq, memory_order_relaxed) ;
+    atomic_store_explicit(&p->seq, seq + 1, memory_order_relaxed) ;
+    atomic_thread_fence(memory_order_release) ;
+
+    if (atomic_load_explicit(&p->reset, memory_order_relaxed)) {
+        atomic_store_explicit(&p->reset, false, memory_order_relaxed) ;
+        clear_stats(s) ;
+        p->started = false ;
+    }
+
+    s->blocks++ ;
+    s->busy_sum += busy ;
+    if (busy < s->busy_min) s->busy_min = busy ;
+    if (busy > s->busy_max) s->busy_max = busy ;
+    if (busy > budget) s->overruns++ ;
+    histogram_add(s->busy_hist, busy, ISR_PROFILE_BUSY_RANGE(budget)) ;
+
+    // Jitter: distance of this entry from one period after the last
+    if (p->started) {
+        uint32_t period = (p->entry - p->last_entry) & tick_mask ;
+        uint32_t jitter = (period > budget) ? period - budget : budget - period ;
+        s->jitter_sum += jitter ;
+        if (jitter < s->jitter_min) s->jitter_min = jitter ;
+        if (jitter > s->jitter_max) s->jitter_max = jitter ;
+        histogram_add(s->jitter_hist, jitter, ISR_PROFILE_JITTER_RANGE(budget)) ;
+    }
+    p->last_entry = p->entry ;
+    p->started = true ;
+
+    atomic_store_explicit(&p->seq, seq + 2, memory_order_release) ;
+}
+
+void isr_profile_snapshot(unsigned int core, isr_profile_stats *stats) {
+    core_profile *p = &profile[core] ;
+    unsigned int seq ;
+    do {
+        seq = atomic_load_explicit(&p->seq, memory_order_acquire) ;
+        *stats = p->stats ;
+        atomic_thread_fence(memory_order_acquire) ;
+    } while ((seq & 1) || seq != atomic_load_explicit(&p->seq, memory_order_relaxed)) ;
+}
+
+void isr_profile_reset(void) {
+    for (int c = 0; c < ISR_PROFILE_CORES; c++) {
+        atomic_store_explicit(&profile[c].reset, true, memory_order_relaxed) ;
+    }
+}
+
+uint32_t isr_profile_percentile(const uint32_t *hist, uint32_t blocks, uint32_t range,
+                                uint32_t min, uint32_t max, int pct) {
+    uint64_t target = ((uint64_t)blocks * pct + 99) / 100 ;
+    uint64_t seen = 0 ;
+    for (int b = 0; b < ISR_PROFILE_BUCKETS - 1; b++) {
+        seen += hist[b] ;
+        if (seen < target) continue ;
+        // Upper edge of the bucket that holds the target block
+        uint32_t edge = (uint32_t)(((uint64_t)(b + 1) * range) / ISR_PROFILE_BUCKETS) ;
+        return edge < min ? min : edge > max ? max : edge ;
+    }
+    return max ;
+}
+
+static void print_line(const char *name, uint32_t min, uint32_t avg, uint32_t max, uint32_t p99) {
+    printf("  %-7s %8lu %8lu %8lu %8lu  %6.1f %6.1f %6.1f %6.1f us\n", name,
+           (unsigned long)min, (unsigned long)avg, (unsigned long)max, (unsigned long)p99,
+           (double)min / ticks_per_us, (double)avg / ticks_per_us,
+           (double)max / ticks_per_us, (double)p99 / ticks_per_us) ;
+}
+
+void isr_profile_print(void) {
+    printf("block interrupts: budget %lu ticks (%.1f us) per block\n",
+           (unsigned long)budget, (double)budget / ticks_per_us) ;
+
+    for (int c = 0; c < ISR_PROFILE_CORES; c++) {
+        isr_profile_stats s ;
+        isr_profile_snapshot(c, &s) ;
+        if (s.blocks == 0) {
+            printf("core %d: no blocks\n", c) ;
+            continue ;
+        }
+
+        uint32_t busy_p99 = isr_profile_percentile(s.busy_hist, s.blocks, ISR_PROFILE_BUSY_RANGE(budget),
+                                                   s.busy_min, s.busy_max, 99) ;
+        printf("core %d: %lu blocks, %lu overruns, p99 busy %.0f%% of budget\n", c,
+               (unsigned long)s.blocks, (unsigned long)s.overruns, 100.0 * busy_p99 / budget) ;
+        printf("  %-7s %8s %8s %8s %8s  (ticks, then us)\n", "", "min", "avg", "max", "p99") ;
+        print_line("busy", s.busy_min, (uint32_t)(s.busy_sum / s.blocks), s.busy_max, busy_p99) ;
+        if (s.blocks > 1) {
+            uint32_t periods = s.blocks - 1 ;
+            print_line("jitter", s.jitter_min, (uint32_t)(s.jitter_sum / periods), s.jitter_max,
+                       isr_profile_percentile(s.jitter_hist, periods, ISR_PROFILE_JITTER_RANGE(budget),
+                                              s.jitter_min, s.jitter_max, 99)) ;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * Cycle budget profiler for the audio block interrupts
+ *
+ * Each core's block interrupt passes a timestamp on entry and on exit.
+ * The profiler keeps, per core:
+ *
+ *  - busy time (exit - entry) as min/avg/max and a histogram, from
+ *    which the 99th percentile is read; blocks that took longer than
+ *    the block period are counted as overruns
+ *  - entry jitter: how far each entry strays from one block period
+ *    after the previous one (|period - budget|), also with a histogram
+ *
+ * Timestamps are ticks of a free-running up-counter that wraps at
+ * tick_mask + 1: SysTick cycles on the Pico (audio_hal_pico.c), host
+ * cycles in the host build (audio_hal_host.c simulates the timeline).
+ * One block period is budget ticks.
+ *
+ * Each core is the only writer of its own statistics, so recording
+ * takes no lock: the writer bumps a sequence number around every update
+ * and readers copy the statistics again if it moved (or is odd). A
+ * reset is requested through a flag the writer acts on at its next
+ * block. Recording costs a few dozen cycles per block, not per sample,
+ * so it stays in every build.
+ */
+
+#ifndef ISR_PROFILE_H
+#define ISR_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Profiled cores (block handlers)
+#define ISR_PROFILE_CORES 2
+
+// Busy histogram: 0 to 2x the budget; jitter histogram: 0 to 1/16 of it
+#define ISR_PROFILE_BUCKETS 128
+#define ISR_PROFILE_BUSY_RANGE(budget)   (2 * (budget))
+#define ISR_PROFILE_JITTER_RANGE(budget) ((budget) / 16)
+
+typedef struct {
+    uint32_t blocks ;
+    uint32_t overruns ;                         // busy > budget
+    uint32_t busy_min, busy_max ;               // ticks
+    uint64_t busy_sum ;
+    uint32_t jitter_min, jitter_max ;           // ticks
+    uint64_t jitter_sum ;
+    uint32_t busy_hist[ISR_PROFILE_BUCKETS] ;   // last bucket includes anything longer
+    uint32_t jitter_hist[ISR_PROFILE_BUCKETS] ;
+} isr_profile_stats ;
+
+// Set the block period in ticks, the tick rate (for reports in us) and
+// the counter's wrap mask. Clears every core's statistics.
+void isr_profile_init(uint32_t budget, uint32_t ticks_per_us, uint32_t tick_mask) ;
+
+// Block interrupt entry and exit on a core (from that core only)
+void isr_profile_enter(unsigned int core, uint32_t now) ;
+void isr_profile_exit(unsigned int core, uint32_t now) ;
+
+// Consistent copy of a core's statistics (any core or thread)
+void isr_profile_snapshot(unsigned int core, isr_profile_stats *stats) ;
+
+// Ask every core to clear its statistics at its next block
+void isr_profile_reset(void) ;
+
+// Ticks below which pct percent of a histogram's blocks fall: the top
+// edge of the bucket that holds them, within the measured min and max.
+// The last bucket is open-ended (a late block's jitter is often past
+// the jitter range), so a percentile that lands there is max.
+uint32_t isr_profile_percentile(const uint32_t *hist, uint32_t blocks, uint32_t range,
+                                uint32_t min, uint32_t max, int pct) ;
+
+// Print min/avg/max/p99 of busy time and jitter per core (printf)
+void isr_profile_print(void) ;
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * Windowed-sinc sample-rate converter (see resampler.h)
+ */
+
+#include <string.h>
+
+#include "resampler.h"
+#include "resampler_table.h"
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b ;
+        a = b ;
+        b = t ;
+    }
+    return a ;
+}
+
+// Prototype filter at a Q16 table position, interpolated between points
+static inline int32_t wing_at(const int16_t *wing, uint32_t idx) {
+    uint32_t l = idx >> 16 ;
+    int32_t d = (idx & 0xffff) >> 1 ;
+    return wing[l] + (((wing[l + 1] - wing[l]) * d) >> 15) ;
+}
+
+bool resampler_init(resampler *r, uint32_t rate_in, uint32_t rate_out, int quality) {
+    if (rate_in == 0 || rate_out == 0) return false ;
+    uint32_t g = gcd(rate_in, rate_out) ;
+    rate_in /= g ;
+    rate_out /= g ;
+    if (rate_in > RESAMPLER_MAX_DECIMATION * rate_out) return false ;
+
+    memset(r, 0, sizeof(*r)) ;
+    r->step_int = rate_in / rate_out ;
+    r->step_rem = rate_in % rate_out ;
+    r->den = rate_out ;
+
+    int width ;
+    switch (quality) {
+    case RESAMPLER_LINEAR:
+        r->half_width = 1 ;
+        break ;
+    case RESAMPLER_FAST:
+        r->wing = resampler_fast_wing ;
+        width = RESAMPLER_FAST_WIDTH ;
+        break ;
+    case RESAMPLER_MEDIUM:
+        r->wing = resampler_medium_wing ;
+        width = RESAMPLER_MEDIUM_WIDTH ;
+        break ;
+    case RESAMPLER_BEST:
+        r->wing = resampler_best_wing ;
+        width = RESAMPLER_BEST_WIDTH ;
+        break ;
+    default:
+        return false ;
+    }
+
+    if (r->wing) {
+        r->wing_end = (uint32_t)(width * RESAMPLER_OVERSAMPLE) << 16 ;
+        if (rate_in > rate_out) {
+            // Stretch the kernel (and scale it down) by the full
+            // decimation ratio: half_width, and so the taps, grow with it
+            r->table_step = (uint32_t)(((uint64_t)RESAMPLER_OVERSAMPLE << 16) * rate_out / rate_in) ;
+            r->gain = (int32_t)(((uint64_t)rate_out << 15) / rate_in) ;
+        }
+        else {
+            r->table_step = RESAMPLER_OVERSAMPLE << 16 ;
+            r->gain = 1 << 15 ;
+        }
+        r->half_width = (r->wing_end + r->table_step - 1) / r->table_step ;
+    }
+
+    // Silent history before the first input sample, which lands on the
+    // first output instant
+    r->pos = r->half_width - 1 ;
+    r->fill = r->half_width - 1 ;
+    return true ;
+}
+
+int resampler_write(resampler *r, const int16_t *in, int n) {
+    int taken = 0 ;
+
+    // Input the kernel has already stepped past
+    if (r->skip) {
+        int d = (r->skip < (uint32_t)n) ? (int)r->skip : n ;
+        r->skip -= d ;
+        in += d ;
+        n -= d ;
+        taken = d ;
+    }
+
+    int space = RESAMPLER_BUFFER - r->fill ;
+    if (n > space) n = space ;
+    memcpy(&r->buf[r->fill], in, n * sizeof(int16_t)) ;
+    r->fill += n ;
+    return taken + n ;
+}
+
+static inline int16_t saturate16(int32_t y) {
+    return (y > 32767) ? 32767 : (y < -32768) ? -32768 : (int16_t)y ;
+}
+
+int resampler_read(resampler *r, int16_t *out, int n) {
+    int k = 0 ;
+
+    for (; k < n && r->pos + r->half_width < r->fill; k++) {
+        const int16_t *x = &r->buf[r->pos] ;
+
+        if (r->wing == NULL) {
+            // Straight line between the two neighbours
+            int32_t f = (int32_t)(((uint64_t)r->frac << 15) / r->den) ;
+            out[k] = (int16_t)(x[0] + (((x[1] - x[0]) * f) >> 15)) ;
+        }
+        else {
+            // Output instant, as a Q16 fraction of an input sample
+            uint32_t f = (uint32_t)(((uint64_t)r->frac << 16) / r->den) ;
+            uint32_t step = r->table_step ;
+            uint32_t end = r->wing_end ;
+            int64_t acc = 0 ;
+
+            // Left wing: x[0], x[-1], ... at distances f, f + 1, ...
+            uint32_t idx = (uint32_t)(((uint64_t)f * step) >> 16) ;
+            for (const int16_t *p = x; idx < end; p--, idx += step) {
+                acc += *p * wing_at(r->wing, idx) ;
+            }
+
+            // Right wing: x[1], x[2], ... at distances 1 - f, 2 - f, ...
+            idx = (uint32_t)(((uint64_t)(65536 - f) * step) >> 16) ;
+            for (const int16_t *p = x + 1; idx < end; p++, idx += step) {
+                acc += *p * wing_at(r->wing, idx) ;
+            }
+
+            out[k] = saturate16((int32_t)((acc * r->gain + (1 << 29)) >> 30)) ;
+        }
+
+        // Advance by rate_in / rate_out input samples
+        r->pos += r->step_int ;
+        r->frac += r->step_rem ;
+        if (r->frac >= r->den) {
+            r->frac -= r->den ;
+            r->pos++ ;
+        }
+    }
+
+    // Drop the history no future output can reach
+    int keep_from = r->pos - (r->half_width - 1) ;
+    if (keep_from > 0) {
+        if (keep_from >= r->fill) {
+            r->skip += keep_from - r->fill ;
+            r->fill = 0 ;
+        }
+        else {
+            memmove(r->buf, &r->buf[keep_from], (r->fill - keep_from) * sizeof(int16_t)) ;
+            r->fill -= keep_from ;
+        }
+        r->pos -= keep_from ;
+    }
+    return k ;
+}
+
+int resampler_input_needed(const resampler *r, int n) {
+    if (n <= 0) return 0 ;
+
+    // Position of the n-th output from now, and the last sample it reads
+    uint64_t advance = (uint64_t)r->frac + (uint64_t)(n - 1) * (r->step_int * r->den + r->step_rem) ;
+    int64_t last = r->pos + (int64_t)(advance / r->den) + r->half_width ;
+    int64_t needed = last + 1 - r->fill + r->skip ;
+    return (needed > 0) ? (int)needed : 0 ;
+}
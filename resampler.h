@@ -0,0 +1,86 @@
+/**
+ * Sample-rate converter for sources that do not run at AUDIO_SAMPLE_RATE
+ *
+ * Converts one channel of 16-bit PCM between any two rates with at
+ * most 4:1 decimation (and any amount of interpolation), so a WAV at
+ * 44.1 kHz or a clip at 22.05 kHz can feed the engine at 40 or 48 kHz.
+ * The ratio is kept exactly (reduced by its gcd), so the output never
+ * drifts against the input however long it runs.
+ *
+ * Above RESAMPLER_LINEAR every output sample is a dot product of the
+ * input with a Kaiser-windowed sinc centred on the output instant,
+ * read from the prototype tables of gen_resampler_table.py with linear
+ * interpolation between table points (bandlimited interpolation, one
+ * table for every ratio). When decimating, the kernel is stretched by
+ * the full ratio so its cutoff follows the output Nyquist rate, and the
+ * taps per output sample grow by the same factor, rounded up to whole
+ * samples: 2 * ceil(width * rate_in / rate_out), so 36 for BEST at
+ * 44.1 -> 40 kHz and up to 4x at 4:1 (128 for BEST, 32 for FAST).
+ * RESAMPLER_BUFFER is sized for that widest case. The filter is
+ * symmetric, so output sample k lines up with input time
+ * k * rate_in / rate_out.
+ *
+ * Quality tiers (taps per output sample when not decimating; times the
+ * decimation ratio otherwise):
+ *
+ *  - RESAMPLER_LINEAR:  2, straight-line interpolation, no filtering.
+ *                       Cheapest; images and aliases are audible.
+ *  - RESAMPLER_FAST:    8, 50 dB stopband, flat to about 0.6 x Nyquist.
+ *  - RESAMPLER_MEDIUM: 16, 70 dB stopband, flat to about 0.7 x Nyquist.
+ *  - RESAMPLER_BEST:   32, 90 dB stopband, flat to about 0.8 x Nyquist.
+ *
+ * spatial_bench resample prints the cost and THD+N of each.
+ *
+ * Usage: resampler_write() the input as it arrives and resampler_read()
+ * whatever output it makes possible; resampler_input_needed() says how
+ * much to write to get a whole block out.
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum { RESAMPLER_LINEAR, RESAMPLER_FAST, RESAMPLER_MEDIUM, RESAMPLER_BEST } ;
+
+// Largest rate_in / rate_out
+#define RESAMPLER_MAX_DECIMATION 4
+
+// Input history, in samples: holds the widest kernel (BEST at 4:1
+// decimation reads 128 samples per output) plus the input of one
+// engine block at that ratio
+#define RESAMPLER_BUFFER 320
+
+typedef struct {
+    const int16_t *wing ;       // prototype table (NULL for RESAMPLER_LINEAR)
+    int half_width ;            // input samples each side of the output instant
+    uint32_t wing_end ;         // table length, Q16 table steps
+    uint32_t table_step ;       // table steps per input sample, Q16
+    int32_t gain ;              // kernel scale when decimating, Q15
+    uint32_t step_int ;         // input advance per output sample:
+    uint32_t step_rem ;         //   step_int + step_rem / den
+    uint32_t den ;
+    uint32_t frac ;             // position between buf[pos] and buf[pos+1], in 1/den
+    int pos ;                   // buf index at or before the next output instant
+    int fill ;                  // samples in buf
+    uint32_t skip ;             // input samples to drop before buf continues
+    int16_t buf[RESAMPLER_BUFFER] ;
+} resampler ;
+
+// Set up a converter from rate_in to rate_out (Hz) at a quality tier,
+// with a silent history. Returns false if the ratio is not supported.
+bool resampler_init(resampler *r, uint32_t rate_in, uint32_t rate_out, int quality) ;
+
+// Append up to n input samples. Returns how many were taken (fewer
+// than n only when the history is full: read some output first).
+int resampler_write(resampler *r, const int16_t *in, int n) ;
+
+// Produce up to n output samples from the input written so far.
+// Returns how many were produced.
+int resampler_read(resampler *r, int16_t *out, int n) ;
+
+// Input samples still to be written before n more outputs can be read
+int resampler_input_needed(const resampler *r, int n) ;
+
+#endif
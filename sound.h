@@ -1 +0,0 @@
-const short sound_array[] = 
\ No newline at end of file
@@ -0,0 +1,674 @@
+/**
+ * Spatial audio engine (ILD/ITD)
+ *
+ * The block handlers the two cores run for every captured block. They
+ * only reach the hardware through audio_hal.h, so this file builds both
+ * for the Pico and for the host renderer in host/.
+ *
+ * The engine renders up to SPATIAL_MAX_VOICES voices, each playing one
+ * ADC input or one flash clip (audio_clip.h) from its own azimuth and
+ * level. Each ear decodes clips itself, straight from flash. Voices come from a fixed
+ * pool: a free stack plus a high-water mark make allocating and freeing
+ * O(1), and the published parameters keep a dense list of the active
+ * voices so a block only visits those. Every voice's output is summed
+ * into a 32-bit mix that is clamped to the DAC range once, so adding
+ * voices costs linearly and can only saturate, never wrap.
+ *
+ * The whole sample path is integer: inputs, histories and taps are q15
+ * (fix15.h), gains are fix15 no larger than 1.0, and every per-sample
+ * multiply is a 32-bit one (mulq15). ADC codes are shifted up by 4 bits
+ * on the way in and down by 4 on the way out, so those bits of
+ * headroom carry the fractions of the interpolation and gain stages.
+ * spatial_bench fixed compares the result with a float reference.
+ *
+ * The interaural cues come from azimuth_table.h, generated at build
+ * time from the Woodworth head model (gen_azimuth_table.py). Placing a
+ * voice at any azimuth costs one indexed load per ear per block.
+ *
+ * Voice parameters reach the cores through a double-buffered seqlock:
+ * the control thread (the only writer) fills the spare copy and then
+ * publishes it by bumping a sequence number, and each block handler
+ * copies the published one into its own ear state. Nothing the block
+ * handlers read per sample is shared between cores.
+ *
+ * When a voice moves, its gain and delay would jump at a block
+ * boundary and click. Instead the block after a change ramps the gain
+ * and crossfades between the old and new delay taps (voice_block_ramp),
+ * and only blocks with steady cues take the cheaper path. New voices
+ * fade in the same way, and freed voices fade out over one more block.
+ *
+ * SPATIAL_MODE_HRTF replaces the ILD/ITD cues with a direct-form FIR:
+ * each voice is convolved with the ear's HRIR for its azimuth
+ * (hrir_table.h, gen_hrir_table.py), which also carries the pinna cues
+ * that tell front from back. It reads the same delay lines, so the two
+ * modes can be switched at any block.
+ *
+ * spatial_block_stereo() renders both ears on one core instead. Each
+ * voice then keeps one history and decodes its clip once for both
+ * ears, and the two ears share one 32-bit mix word per frame (SWAR:
+ * left in the low halfword, right in the high one, summed with one add)
+ * that is unpacked straight into both DAC words with one store. The
+ * per-ear gains still take one MULS each: the M0+ has no paired
+ * multiply, and the two ears' gains and taps differ anyway.
+ */
+
+#include <stdatomic.h>
+
+#include "audio_hal.h"
+#include "audio_clip.h"
+#include "delay_line.h"
+#include "azimuth_table.h"
+#include "hrir_table.h"
+#include "spatial_audio.h"
+
+// ADC/DAC codes to q15 samples and back
+#define SPATIAL_CODE_SHIFT 4
+
+// The HRIR taps multiply 12-bit codes; their products are rescaled to q15
+#if HRIR_FRAC_BITS < SPATIAL_CODE_SHIFT
+#error "HRIR_FRAC_BITS too small for the q15 rescale"
+#endif
+
+#if AZIMUTH_TABLE_RATE != AUDIO_SAMPLE_RATE || HRIR_TABLE_RATE != AUDIO_SAMPLE_RATE
+#error "azimuth_table.h / hrir_table.h were generated for a different sample rate"
+#endif
+
+// The HRTF path rebuilds its filter history from the delay lines and
+// unrolls its dot product by four
+#if HRIR_TAPS - 1 > DELAY_LINE_LENGTH || HRIR_TAPS % 4
+#error "HRIR_TAPS must be a multiple of 4 and fit in the delay line"
+#endif
+
+// Mid-scale ADC/DAC code: samples are centred on it for mixing
+#define AUDIO_MIDSCALE 2048
+
+// Stereo mix word: two signed lanes of DAC codes, held as the integer
+// r * 65536 + l. Adding two such words adds both lanes (a negative left
+// lane borrows from the right one, and unpacking gives it back), as
+// long as each lane's sum fits in 16 bits.
+#define SPATIAL_PACK(l, r) ((int32_t)((uint32_t)(r) << 16) + (l))
+#define SPATIAL_LANE_L(w)  ((int16_t)(w))
+#define SPATIAL_LANE_R(w)  (((w) - SPATIAL_LANE_L(w)) >> 16)
+
+// Every voice adds at most one full-scale sample to a lane
+#if SPATIAL_MAX_VOICES * AUDIO_MIDSCALE > 32767
+#error "too many voices for the 16-bit lanes of the stereo mix"
+#endif
+
+// One voice as published to the cores
+typedef struct {
+    int azimuth ;               // degrees clockwise from straight ahead
+    fix15 level ;
+    const audio_clip *clip ;    // input: a clip, or (if 0) ...
+    uint8_t adc_chan ;          // ... an ADC channel
+    uint8_t loop ;              // clip repeats
+    uint8_t generation ;        // bumped on every allocation
+} spatial_voice_params ;
+
+// Everything the block handlers need, published as one snapshot
+typedef struct {
+    spatial_voice_params voice[SPATIAL_MAX_VOICES] ;
+    uint8_t active[SPATIAL_MAX_VOICES] ;    // allocated voices, dense
+    int active_count ;
+    int mode ;                  // SPATIAL_MODE_ILD_ITD or SPATIAL_MODE_HRTF
+} spatial_params ;
+
+// Private state of one voice at one ear
+typedef struct {
+    delay_line history ;        // centred q15 input history
+    uint8_t generation ;        // allocation this state belongs to
+    audio_clip_reader reader ;  // clip position (reader.clip 0 for ADC input)
+    uint8_t adc_chan ;          // input, loop and azimuth as last rendered
+    uint8_t loop ;
+    int azimuth ;
+    uint32_t stamp ;            // block it was last rendered in
+    fix15 gain ;                // ILD gain * level, last block
+    fix15 delay ;               // ITD delay, last block
+    const int16_t *hrir ;       // HRIR, last HRTF block
+    fix15 hrir_level ;          // ... and its level
+} spatial_voice_state ;
+
+// Private state of one ear. Each core keeps its own copy of every
+// voice's history and parameters, so neither core touches the other's
+// data.
+typedef struct {
+    spatial_voice_state voice[SPATIAL_MAX_VOICES] ;
+    spatial_params params ;     // last published parameters seen
+    unsigned int params_seq ;   // ... and their sequence number
+    uint8_t rendered[SPATIAL_MAX_VOICES] ;  // voices active last block
+    int rendered_count ;
+    q15 slices[AUDIO_IN_CHANNELS][AUDIO_BLOCK_SIZE] ;   // this block's inputs
+    q15 clip_block[AUDIO_BLOCK_SIZE] ;      // one voice's decoded clip block
+    volatile uint8_t done[SPATIAL_MAX_VOICES] ; // generation whose clip ended
+
+    uint32_t block ;            // blocks processed
+} spatial_ear_state ;
+
+static spatial_ear_state ears[2] = {
+    [EAR_LEFT]  = {.params_seq = ~0u},
+    [EAR_RIGHT] = {.params_seq = ~0u},
+} ;
+
+// Start-up parameters: the right input (ADC 2) and the left input
+// (ADC 0) 45 degrees off centre at half level, as voices 0 and 1
+#define SPATIAL_DEFAULT_PARAMS {                                                \
+    .voice = {                                                                  \
+        [SOURCE_R] = {.azimuth = 45,  .level = float2fix15(0.5),                \
+                      .adc_chan = ADC_CHAN_2, .generation = 1},                 \
+        [SOURCE_L] = {.azimuth = 315, .level = float2fix15(0.5),                \
+                      .adc_chan = ADC_CHAN_0, .generation = 1},                 \
+    },                                                                          \
+    .active = {SOURCE_R, SOURCE_L},                                             \
+    .active_count = 2,                                                          \
+}
+
+// Published parameters: params_buf[params_seq & 1] is current, the other
+// copy belongs to the writer
+static spatial_params params_buf[2] = {SPATIAL_DEFAULT_PARAMS} ;
+static atomic_uint params_seq ;
+
+// Writer-side state (control thread only): the next parameters, where
+// each voice sits in params_next.active, and the voice pool. Voices
+// below pool_high_water have been handed out at least once; freed ones
+// are stacked on pool_free.
+static spatial_params params_next = SPATIAL_DEFAULT_PARAMS ;
+static uint8_t active_slot[SPATIAL_MAX_VOICES] = {[SOURCE_R] = 0, [SOURCE_L] = 1} ;
+static uint8_t pool_free[SPATIAL_MAX_VOICES] ;
+static int pool_free_count ;
+static int pool_high_water = 2 ;
+
+// Fade advance per sample of a transition block (0 to 1 over the block)
+#define SPATIAL_RAMP_STEP (int2fix15(1) / AUDIO_BLOCK_SIZE)
+
+// Cue changes ramp over a block unless turned off (A/B measurements)
+static int spatial_ramp_enabled = 1 ;
+
+// Azimuth of each of the joystick direction states: 80 and 45 degrees
+// to the right, straight ahead, 45 and 80 degrees to the left
+static const int direction_azimuth[5] = {80, 45, 0, 315, 280} ;
+
+// Level of each direction state (the 80 degree states sound further away)
+static const fix15 direction_level[5] = {
+    float2fix15(0.1), float2fix15(0.5), float2fix15(0.5), float2fix15(0.5), float2fix15(0.1)
+} ;
+
+//========================================================================
+// Control thread: voice pool and parameter updates
+//========================================================================
+
+// Publish params_next through the spare buffer
+static void spatial_publish(void) {
+    unsigned int seq = atomic_load_explicit(&params_seq, memory_order_relaxed) ;
+    params_buf[(seq + 1) & 1] = params_next ;
+    atomic_store_explicit(&params_seq, seq + 1, memory_order_release) ;
+}
+
+// Block handler: refresh this ear's copy if anything was published.
+// A reader on the writer's core can't be interrupted by the writer, and
+// the other core only retries if two updates land during one copy.
+static void spatial_read_params(spatial_ear_state *e) {
+    unsigned int seq = atomic_load_explicit(&params_seq, memory_order_acquire) ;
+    while (seq != e->params_seq) {
+        e->params = params_buf[seq & 1] ;
+        e->params_seq = seq ;
+        seq = atomic_load_explicit(&params_seq, memory_order_acquire) ;
+    }
+}
+
+// Move a voice in params_next (published by the caller)
+static void spatial_place(int voice, int azimuth, fix15 level) {
+    // Wrap into 0-359
+    azimuth %= AZIMUTH_STEPS ;
+    if (azimuth < 0) azimuth += AZIMUTH_STEPS ;
+
+    // Gains stay within 1.0 so the sample path needs no 64-bit multiply
+    if (level < 0) level = 0 ;
+    if (level > int2fix15(1)) level = int2fix15(1) ;
+
+    params_next.voice[voice].azimuth = azimuth ;
+    params_next.voice[voice].level = level ;
+}
+
+// Take a voice from the pool, set its input and position, and publish
+static int spatial_voice_take(const audio_clip *clip, int loop, unsigned int adc_chan,
+                              int azimuth, fix15 level) {
+    int voice ;
+    if (pool_free_count > 0) voice = pool_free[--pool_free_count] ;
+    else if (pool_high_water < SPATIAL_MAX_VOICES) voice = pool_high_water++ ;
+    else return -1 ;
+
+    spatial_voice_params *v = &params_next.voice[voice] ;
+    v->clip = clip ;
+    v->loop = loop ;
+    v->adc_chan = adc_chan ;
+    v->generation++ ;
+    spatial_place(voice, azimuth, level) ;
+
+    // Append to the active list
+    active_slot[voice] = params_next.active_count ;
+    params_next.active[params_next.active_count++] = voice ;
+    spatial_publish() ;
+    return voice ;
+}
+
+int spatial_voice_alloc(unsigned int adc_chan, int azimuth, fix15 level) {
+    return spatial_voice_take(0, 0, adc_chan, azimuth, level) ;
+}
+
+int spatial_voice_play(const audio_clip *clip, int loop, int azimuth, fix15 level) {
+    return spatial_voice_take(clip, loop, 0, azimuth, level) ;
+}
+
+// A voice handle that is in range and allocated now
+static int voice_allocated(int voice) {
+    if (voice < 0 || voice >= SPATIAL_MAX_VOICES) return 0 ;
+    int slot = active_slot[voice] ;
+    return slot < params_next.active_count && params_next.active[slot] == voice ;
+}
+
+int spatial_voice_done(int voice) {
+    if (!voice_allocated(voice)) return 0 ;
+    // Each ear marks the allocation whose clip it finished
+    uint8_t generation = params_next.voice[voice].generation ;
+    return ears[EAR_LEFT].done[voice] == generation && ears[EAR_RIGHT].done[voice] == generation ;
+}
+
+void spatial_voice_free(int voice) {
+    // A second free would take another voice's slot and stack a duplicate
+    if (!voice_allocated(voice)) return ;
+    // Move the last active voice into the freed slot
+    int slot = active_slot[voice] ;
+    int last = params_next.active[--params_next.active_count] ;
+    params_next.active[slot] = last ;
+    active_slot[last] = slot ;
+
+    pool_free[pool_free_count++] = voice ;
+    spatial_publish() ;
+}
+
+int spatial_voices_active(void) {
+    return params_next.active_count ;
+}
+
+void spatial_set_azimuth(int voice, int azimuth, fix15 level) {
+    if (!voice_allocated(voice)) return ;
+    spatial_place(voice, azimuth, level) ;
+    spatial_publish() ;
+}
+
+void spatial_set_direction_state(int voice, int state) {
+    if (state < 0 || state > 4) return ;
+    spatial_set_azimuth(voice, direction_azimuth[state], direction_level[state]) ;
+}
+
+void spatial_set_direction(int direction) {
+    // Both inputs move in one update
+    if (direction==0 || direction==1) {
+        spatial_place(SOURCE_R, direction_azimuth[2], direction_level[2]) ;
+        spatial_place(SOURCE_L, direction_azimuth[4], direction_level[4]) ;
+        spatial_publish() ;
+    }
+    else if (direction==3 || direction==4) {
+        spatial_place(SOURCE_R, direction_azimuth[0], direction_level[0]) ;
+        spatial_place(SOURCE_L, direction_azimuth[2], direction_level[2]) ;
+        spatial_publish() ;
+    }
+}
+
+void spatial_set_mode(int mode) {
+    params_next.mode = mode ;
+    spatial_publish() ;
+}
+
+void spatial_set_ramp(int enabled) {
+    spatial_ramp_enabled = enabled ;
+}
+
+//========================================================================
+// Block handlers: one voice at one ear
+//========================================================================
+
+// Steady block: the cues did not change since the last block
+static void voice_block_steady(spatial_voice_state *v, const q15 *x, int32_t *mix) {
+    fix15 delay = v->delay, gain = v->gain ;
+
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        // Update history data
+        delay_line_push(&v->history, x[i]) ;
+        mix[i] += mulq15(delay_line_tap_frac(&v->history, delay), gain) ;
+    }
+}
+
+// Transition block: ramp the gain linearly from its old value to the
+// new one, and crossfade from the old delay tap to the new one, over the
+// block. Both reach their targets on the last sample: the step is
+// truncated, so the first one also takes the remainder (under one LSB
+// per sample of the block).
+static void voice_block_ramp(spatial_voice_state *v, fix15 gain_to, fix15 delay_to,
+                             const q15 *x, int32_t *mix) {
+    fix15 gain_step = (gain_to - v->gain) / AUDIO_BLOCK_SIZE ;
+    fix15 gain = gain_to - gain_step * AUDIO_BLOCK_SIZE ;
+    fix15 fade = 0 ;
+
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        delay_line_push(&v->history, x[i]) ;
+        fade += SPATIAL_RAMP_STEP ;
+
+        int32_t y = delay_line_tap_frac(&v->history, v->delay) ;
+        if (delay_to != v->delay) {
+            y += ((delay_line_tap_frac(&v->history, delay_to) - y) * fade) >> 15 ;
+        }
+        gain += gain_step ;
+        mix[i] += mulq15(y, gain) ;
+    }
+}
+
+// ILD/ITD: one table load gives this ear's gain and delay for the block
+static void voice_block_ild(spatial_voice_state *v, int ear, fix15 level, const q15 *x, int32_t *mix) {
+    const azimuth_cue *cue = &azimuth_table[v->azimuth] ;
+    fix15 delay_to = cue->delay[ear] ;
+    // Both at most 1.0, so the product fits in 32 bits
+    fix15 gain_to = (cue->gain[ear] * level) >> 15 ;
+
+    if (spatial_ramp_enabled && (gain_to != v->gain || delay_to != v->delay)) {
+        voice_block_ramp(v, gain_to, delay_to, x, mix) ;
+        v->gain = gain_to ;
+        v->delay = delay_to ;
+    }
+    else {
+        v->gain = gain_to ;
+        v->delay = delay_to ;
+        voice_block_steady(v, x, mix) ;
+    }
+}
+
+// Dot product of HRIR_TAPS history samples with a time-reversed HRIR
+// (12-bit signed inputs, HRIR_FRAC_BITS coefficients, 32-bit sum)
+static inline int32_t hrir_dot(const int16_t *x, const int16_t *h) {
+    int32_t acc = 0 ;
+    for (int k = 0; k < HRIR_TAPS; k += 4) {
+        acc += x[k] * h[k] + x[k+1] * h[k+1] + x[k+2] * h[k+2] + x[k+3] * h[k+3] ;
+    }
+    return acc ;
+}
+
+// One output sample of a voice through an HRIR, as a q15 sample. The
+// dot product is below 2^31 (gen_hrir_table.py checks), so with the
+// level cut to 10 bits the scaled product fits in 32 bits too. An HRIR
+// can have gain above 1, so the result is saturated: that also keeps
+// the crossfade's products in 32 bits.
+static inline q15 hrir_sample(const int16_t *x, const int16_t *h, fix15 level) {
+    return satq15(((hrir_dot(x, h) >> (HRIR_FRAC_BITS - SPATIAL_CODE_SHIFT)) * (level >> 5)) >> 10) ;
+}
+
+// Filter history as 12-bit codes, oldest first: the previous
+// HRIR_TAPS-1 inputs from the delay line, then this block (which is
+// pushed onto the line)
+static void hrtf_history(spatial_voice_state *v, const q15 *x, int16_t *hx) {
+    for (int j = 0; j < HRIR_TAPS - 1; j++) {
+        hx[j] = delay_line_tap(&v->history, HRIR_TAPS - 2 - j) >> SPATIAL_CODE_SHIFT ;
+    }
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        hx[HRIR_TAPS - 1 + i] = x[i] >> SPATIAL_CODE_SHIFT ;
+        delay_line_push(&v->history, x[i]) ;
+    }
+}
+
+// This ear's HRIR for a voice's azimuth
+static inline const int16_t *hrtf_hrir(const spatial_voice_state *v, int ear) {
+    int index = ((v->azimuth + HRIR_AZIMUTH_STEP / 2) / HRIR_AZIMUTH_STEP) % HRIR_AZIMUTHS ;
+    return hrir_table[index][ear] ;
+}
+
+// Add one ear's convolution of the filter history into mix. A changed
+// HRIR or level is crossfaded over the block like the ILD/ITD cues (two
+// convolutions for that block).
+static void hrtf_ear(spatial_voice_state *v, const int16_t *h, fix15 level, const int16_t *hx, int32_t *mix) {
+    if (v->hrir && (v->hrir != h || v->hrir_level != level) && spatial_ramp_enabled) {
+        fix15 fade = 0 ;
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            fade += SPATIAL_RAMP_STEP ;
+            int32_t from = hrir_sample(&hx[i], v->hrir, v->hrir_level) ;
+            mix[i] += from + (((hrir_sample(&hx[i], h, level) - from) * fade) >> 15) ;
+        }
+    }
+    else {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            mix[i] += hrir_sample(&hx[i], h, level) ;
+        }
+    }
+    v->hrir = h ;
+    v->hrir_level = level ;
+}
+
+// HRTF: convolve the voice with this ear's HRIR for its azimuth
+static void voice_block_hrtf(spatial_voice_state *v, int ear, fix15 level, const q15 *x, int32_t *mix) {
+    int16_t hx[HRIR_TAPS - 1 + AUDIO_BLOCK_SIZE] ;
+    hrtf_history(v, x, hx) ;
+    hrtf_ear(v, hrtf_hrir(v, ear), level, hx, mix) ;
+}
+
+// Start a voice's ear state over for a new allocation: silent history,
+// and gain 0 so the first block fades in
+static void voice_reset(spatial_voice_state *v, const spatial_voice_params *p) {
+    for (int i = 0; i < DELAY_LINE_LENGTH; i++) v->history.buf[i] = 0 ;
+    v->generation = p->generation ;
+    v->adc_chan = p->adc_chan ;
+    v->loop = p->loop ;
+    v->reader.clip = p->clip ;
+    v->reader.pos = 0 ;
+    v->gain = 0 ;
+    v->delay = 0 ;
+    v->hrir = 0 ;
+    v->hrir_level = 0 ;
+}
+
+// This block of a voice's input: its ADC slice, or the next block of its
+// clip decoded into the ear's scratch block
+static const q15 *voice_input(spatial_ear_state *e, int n, spatial_voice_state *v) {
+    if (!v->reader.clip) return e->slices[v->adc_chan] ;
+
+    audio_clip_read(&v->reader, e->clip_block, AUDIO_BLOCK_SIZE, v->loop) ;
+    if (!v->loop && audio_clip_finished(&v->reader)) e->done[n] = v->generation ;
+    return e->clip_block ;
+}
+
+// Add one block of a voice (input slice x) into mix
+static void voice_block(spatial_ear_state *e, int ear, spatial_voice_state *v, fix15 level,
+                        const q15 *x, int32_t *mix) {
+    if (e->params.mode == SPATIAL_MODE_HRTF) voice_block_hrtf(v, ear, level, x, mix) ;
+    else voice_block_ild(v, ear, level, x, mix) ;
+    v->stamp = e->block ;
+}
+
+//========================================================================
+// Block handlers: one ear
+//========================================================================
+
+// This block of every ADC channel, centred on zero (kept in the ear
+// state rather than on the interrupt stack)
+static void spatial_read_slices(spatial_ear_state *e, const uint16_t *in) {
+    for (int c = 0; c < AUDIO_IN_CHANNELS; c++) {
+        uint16_t slice[AUDIO_BLOCK_SIZE] ;
+        audio_in_slice(in, c, slice) ;
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            e->slices[c][i] = (q15)((slice[i] - AUDIO_MIDSCALE) << SPATIAL_CODE_SHIFT) ;
+        }
+    }
+}
+
+// Process one block for one ear: mix every active voice as heard by
+// that ear into its DAC words of the output block
+static void spatial_block(int ear, const uint16_t *in, uint16_t *out) {
+    spatial_ear_state *e = &ears[ear] ;
+    spatial_read_params(e) ;
+    e->block++ ;
+    spatial_read_slices(e, in) ;
+
+    int32_t mix[AUDIO_BLOCK_SIZE] = {0} ;
+
+    // Active voices (a new allocation starts from a clean state)
+    for (int a = 0; a < e->params.active_count; a++) {
+        int n = e->params.active[a] ;
+        const spatial_voice_params *p = &e->params.voice[n] ;
+        spatial_voice_state *v = &e->voice[n] ;
+        if (v->generation != p->generation) voice_reset(v, p) ;
+        v->azimuth = p->azimuth ;
+        voice_block(e, ear, v, p->level, voice_input(e, n, v), mix) ;
+    }
+
+    // Voices freed since the last block fade out where they were
+    for (int a = 0; a < e->rendered_count; a++) {
+        int n = e->rendered[a] ;
+        spatial_voice_state *v = &e->voice[n] ;
+        if (v->stamp != e->block && spatial_ramp_enabled) {
+            voice_block(e, ear, v, 0, voice_input(e, n, v), mix) ;
+        }
+    }
+
+    // Remember who was audible, for the fade outs next block
+    for (int a = 0; a < e->params.active_count; a++) {
+        e->rendered[a] = e->params.active[a] ;
+    }
+    e->rendered_count = e->params.active_count ;
+
+    // Saturate the mix into the ear's output words (the left ear is DAC
+    // channel A)
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        out[AUDIO_OUT_CHANNELS * i + ear] = audio_out_word(ear, mix[i]) ;
+    }
+}
+
+//========================================================================
+// One core, both ears (spatial_block_stereo)
+//========================================================================
+
+// ILD/ITD for both ears from the voice's one history (in the left ear's
+// state; the right ear's state only keeps its cues). Each ear's sample
+// is rounded to DAC codes and both go into the mix word with one add.
+static void voice_block_ild_stereo(spatial_voice_state *vl, spatial_voice_state *vr, fix15 level,
+                                   const q15 *x, int32_t *mix) {
+    const azimuth_cue *cue = &azimuth_table[vl->azimuth] ;
+    fix15 gain_l = (cue->gain[EAR_LEFT] * level) >> 15, gain_r = (cue->gain[EAR_RIGHT] * level) >> 15 ;
+    fix15 delay_l = cue->delay[EAR_LEFT], delay_r = cue->delay[EAR_RIGHT] ;
+    delay_line *h = &vl->history ;
+
+    if (spatial_ramp_enabled && (gain_l != vl->gain || delay_l != vl->delay ||
+                                 gain_r != vr->gain || delay_r != vr->delay)) {
+        // Transition block, as voice_block_ramp for each ear
+        fix15 step_l = (gain_l - vl->gain) / AUDIO_BLOCK_SIZE, step_r = (gain_r - vr->gain) / AUDIO_BLOCK_SIZE ;
+        fix15 gl = gain_l - step_l * AUDIO_BLOCK_SIZE, gr = gain_r - step_r * AUDIO_BLOCK_SIZE ;
+        fix15 fade = 0 ;
+
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            delay_line_push(h, x[i]) ;
+            fade += SPATIAL_RAMP_STEP ;
+
+            int32_t yl = delay_line_tap_frac(h, vl->delay) ;
+            if (delay_l != vl->delay) yl += ((delay_line_tap_frac(h, delay_l) - yl) * fade) >> 15 ;
+            int32_t yr = delay_line_tap_frac(h, vr->delay) ;
+            if (delay_r != vr->delay) yr += ((delay_line_tap_frac(h, delay_r) - yr) * fade) >> 15 ;
+            gl += step_l ;
+            gr += step_r ;
+            mix[i] += SPATIAL_PACK(mulq15(yl, gl) >> SPATIAL_CODE_SHIFT, mulq15(yr, gr) >> SPATIAL_CODE_SHIFT) ;
+        }
+    }
+    else {
+        for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+            delay_line_push(h, x[i]) ;
+            int32_t yl = mulq15(delay_line_tap_frac(h, delay_l), gain_l) >> SPATIAL_CODE_SHIFT ;
+            int32_t yr = mulq15(delay_line_tap_frac(h, delay_r), gain_r) >> SPATIAL_CODE_SHIFT ;
+            mix[i] += SPATIAL_PACK(yl, yr) ;
+        }
+    }
+    vl->gain = gain_l ;
+    vl->delay = delay_l ;
+    vr->gain = gain_r ;
+    vr->delay = delay_r ;
+}
+
+// HRTF for both ears: one filter history, two convolutions
+static void voice_block_hrtf_stereo(spatial_voice_state *vl, spatial_voice_state *vr, fix15 level,
+                                    const q15 *x, int32_t *mix) {
+    int16_t hx[HRIR_TAPS - 1 + AUDIO_BLOCK_SIZE] ;
+    int32_t y[2][AUDIO_BLOCK_SIZE] = {{0}} ;
+
+    hrtf_history(vl, x, hx) ;
+    hrtf_ear(vl, hrtf_hrir(vl, EAR_LEFT), level, hx, y[EAR_LEFT]) ;
+    hrtf_ear(vr, hrtf_hrir(vl, EAR_RIGHT), level, hx, y[EAR_RIGHT]) ;
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        mix[i] += SPATIAL_PACK(y[EAR_LEFT][i] >> SPATIAL_CODE_SHIFT, y[EAR_RIGHT][i] >> SPATIAL_CODE_SHIFT) ;
+    }
+}
+
+// Add one block of a voice at both ears into the stereo mix
+static void voice_block_stereo(spatial_ear_state *e, spatial_voice_state *vl, spatial_voice_state *vr,
+                               fix15 level, const q15 *x, int32_t *mix) {
+    if (e->params.mode == SPATIAL_MODE_HRTF) voice_block_hrtf_stereo(vl, vr, level, x, mix) ;
+    else voice_block_ild_stereo(vl, vr, level, x, mix) ;
+    vl->stamp = e->block ;
+}
+
+// The left ear's state carries everything shared (parameters, inputs,
+// voice histories, fade-outs); the right ear's voice states keep the
+// right ear's cues
+void spatial_block_stereo(const uint16_t *in, uint16_t *out) {
+    spatial_ear_state *e = &ears[EAR_LEFT], *er = &ears[EAR_RIGHT] ;
+    spatial_read_params(e) ;
+    e->block++ ;
+    spatial_read_slices(e, in) ;
+
+    int32_t mix[AUDIO_BLOCK_SIZE] = {0} ;
+
+    for (int a = 0; a < e->params.active_count; a++) {
+        int n = e->params.active[a] ;
+        const spatial_voice_params *p = &e->params.voice[n] ;
+        spatial_voice_state *vl = &e->voice[n], *vr = &er->voice[n] ;
+        if (vl->generation != p->generation) {
+            voice_reset(vl, p) ;
+            voice_reset(vr, p) ;
+        }
+        vl->azimuth = p->azimuth ;
+        voice_block_stereo(e, vl, vr, p->level, voice_input(e, n, vl), mix) ;
+        er->done[n] = e->done[n] ;
+    }
+
+    for (int a = 0; a < e->rendered_count; a++) {
+        int n = e->rendered[a] ;
+        spatial_voice_state *vl = &e->voice[n] ;
+        if (vl->stamp != e->block && spatial_ramp_enabled) {
+            voice_block_stereo(e, vl, &er->voice[n], 0, voice_input(e, n, vl), mix) ;
+        }
+    }
+
+    for (int a = 0; a < e->params.active_count; a++) {
+        e->rendered[a] = e->params.active[a] ;
+    }
+    e->rendered_count = e->params.active_count ;
+
+    // Unpack, saturate and store both output words of a frame at once
+    // (channel A, the left ear, is the lower address). The lanes hold
+    // DAC codes, so I2S output gets 12-bit resolution from this handler.
+    uint32_t *frames = (uint32_t *)out ;
+    for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+        uint16_t l = audio_out_word(EAR_LEFT, SPATIAL_LANE_L(mix[i]) << SPATIAL_CODE_SHIFT) ;
+        uint16_t r = audio_out_word(EAR_RIGHT, SPATIAL_LANE_R(mix[i]) << SPATIAL_CODE_SHIFT) ;
+        frames[i] = ((uint32_t)r << 16) | l ;
+    }
+}
+
+//========================================================================
+// Core 1 - LEFT
+//========================================================================
+
+void spatial_block_core_1(const uint16_t *in, uint16_t *out) {
+    spatial_block(EAR_LEFT, in, out) ;
+}
+
+//========================================================================
+// Core 0 - RIGHT
+//========================================================================
+
+void spatial_block_core_0(const uint16_t *in, uint16_t *out) {
+    spatial_block(EAR_RIGHT, in, out) ;
+}
@@ -0,0 +1,114 @@
+# Build-time tables for the spatial audio engine
+#
+# Included by the firmware CMakeLists.txt and by host/CMakeLists.txt so
+# both builds generate identical tables from the same head model.
+
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+# Engine sample rate (passed to the compiler as AUDIO_SAMPLE_RATE)
+set(AUDIO_SAMPLE_RATE 40000)
+
+# Head model (head_radius in cm, speed_sound in cm/s)
+set(HEAD_RADIUS 9.0)
+set(SPEED_SOUND 34000.0)
+
+# HRTF mode: taps per ear (multiple of 4, at most 65) and azimuth step
+set(HRIR_TAPS 64)
+set(HRIR_AZIMUTH_STEP 5)
+
+# Resampler: prototype filter points per input sample
+set(RESAMPLER_OVERSAMPLE 128)
+
+set(SPATIAL_AUDIO_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# WAV files packed into flash clips (audio_assets.h, ASSET_<NAME>)
+set(AUDIO_ASSETS ${SPATIAL_AUDIO_DIR}/harvard.wav)
+
+# Clip peak level in dBFS, or OFF to keep the recorded levels
+set(AUDIO_ASSET_NORMALIZE -1.0)
+
+# bin: one image with a directory header, linked in with .incbin (needs
+# the ASM language enabled); c: the clips as a const array in C
+set(AUDIO_ASSET_FORMAT bin)
+
+# Generate the tables into the build tree and put them on TARGET's include path
+function(spatial_audio_generate_tables TARGET)
+    set(gen_dir ${CMAKE_CURRENT_BINARY_DIR}/generated)
+    file(MAKE_DIRECTORY ${gen_dir})
+
+    add_custom_command(
+        OUTPUT ${gen_dir}/azimuth_table.h
+        COMMAND ${Python3_EXECUTABLE} ${SPATIAL_AUDIO_DIR}/gen_azimuth_table.py
+                --head-radius ${HEAD_RADIUS} --speed-sound ${SPEED_SOUND}
+                --rate ${AUDIO_SAMPLE_RATE} -o ${gen_dir}/azimuth_table.h
+        DEPENDS ${SPATIAL_AUDIO_DIR}/gen_azimuth_table.py
+        COMMENT "Generating azimuth_table.h"
+        )
+
+    add_custom_command(
+        OUTPUT ${gen_dir}/hrir_table.h
+        COMMAND ${Python3_EXECUTABLE} ${SPATIAL_AUDIO_DIR}/gen_hrir_table.py
+                --head-radius ${HEAD_RADIUS} --speed-sound ${SPEED_SOUND}
+                --rate ${AUDIO_SAMPLE_RATE} --taps ${HRIR_TAPS} --step ${HRIR_AZIMUTH_STEP}
+                -o ${gen_dir}/hrir_table.h
+        DEPENDS ${SPATIAL_AUDIO_DIR}/gen_hrir_table.py
+        COMMENT "Generating hrir_table.h"
+        )
+
+    add_custom_command(
+        OUTPUT ${gen_dir}/resampler_table.h
+        COMMAND ${Python3_EXECUTABLE} ${SPATIAL_AUDIO_DIR}/gen_resampler_table.py
+                --oversample ${RESAMPLER_OVERSAMPLE} -o ${gen_dir}/resampler_table.h
+        DEPENDS ${SPATIAL_AUDIO_DIR}/gen_resampler_table.py ${SPATIAL_AUDIO_DIR}/windowed_sinc.py
+        COMMENT "Generating resampler_table.h"
+        )
+
+    target_sources(${TARGET} PRIVATE ${gen_dir}/azimuth_table.h ${gen_dir}/hrir_table.h
+            ${gen_dir}/resampler_table.h)
+    target_include_directories(${TARGET} PUBLIC ${gen_dir})
+    target_compile_definitions(${TARGET} PUBLIC AUDIO_SAMPLE_RATE=${AUDIO_SAMPLE_RATE})
+endfunction()
+
+# Pack AUDIO_ASSETS into mu-law clips and build them, with the clip
+# decoder, into TARGET
+function(spatial_audio_generate_assets TARGET)
+    set(gen_dir ${CMAKE_CURRENT_BINARY_DIR}/generated)
+    file(MAKE_DIRECTORY ${gen_dir})
+
+    # Compare as a string: a 0 dBFS peak (0, 0.0) is false to if()
+    string(TOUPPER "${AUDIO_ASSET_NORMALIZE}" normalize_level)
+    if(normalize_level STREQUAL "OFF" OR normalize_level STREQUAL "")
+        set(normalize --no-normalize)
+    else()
+        set(normalize --normalize ${AUDIO_ASSET_NORMALIZE})
+    endif()
+
+    set(outputs ${gen_dir}/audio_assets.h ${gen_dir}/audio_assets.c)
+    if(AUDIO_ASSET_FORMAT STREQUAL "bin")
+        set(image --format bin --image ${gen_dir}/audio_assets.bin --asm ${gen_dir}/audio_assets.S)
+        list(APPEND outputs ${gen_dir}/audio_assets.S)
+        # .incbin is not tracked as a dependency: rebuild when the image does
+        set_source_files_properties(${gen_dir}/audio_assets.S PROPERTIES
+                OBJECT_DEPENDS ${gen_dir}/audio_assets.bin)
+    else()
+        set(image --format c)
+    endif()
+
+    add_custom_command(
+        OUTPUT ${outputs}
+        BYPRODUCTS ${gen_dir}/audio_assets.bin
+        COMMAND ${Python3_EXECUTABLE} ${SPATIAL_AUDIO_DIR}/gen_audio_assets.py
+                --rate ${AUDIO_SAMPLE_RATE} ${normalize}
+                --header ${gen_dir}/audio_assets.h --source ${gen_dir}/audio_assets.c
+                ${image} ${AUDIO_ASSETS}
+        DEPENDS ${SPATIAL_AUDIO_DIR}/gen_audio_assets.py ${SPATIAL_AUDIO_DIR}/windowed_sinc.py
+                ${AUDIO_ASSETS}
+        COMMENT "Packing audio assets"
+        )
+
+    target_sources(${TARGET} PRIVATE
+            ${outputs}
+            ${SPATIAL_AUDIO_DIR}/audio_clip.c
+            )
+    target_include_directories(${TARGET} PUBLIC ${gen_dir})
+endfunction()
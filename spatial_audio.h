@@ -0,0 +1,99 @@
+/**
+ * Spatial audio engine (ILD/ITD)
+ *
+ * Each call to spatial_block_core_x() processes one block (see
+ * audio_hal.h) for one ear: it pushes every active voice's input into
+ * that ear's private history, applies the interaural level (ILD) and
+ * time (ITD) differences of the voice's azimuth, and writes the
+ * saturated mix to that ear's DAC words of the output block.
+ *
+ *  - spatial_block_core_0(): RIGHT ear, DAC channel B
+ *  - spatial_block_core_1(): LEFT ear,  DAC channel A
+ *
+ * or spatial_block_stereo() renders both ears on one core, leaving the
+ * other free. Attach either the pair or the stereo handler, not both.
+ *
+ * A voice plays one ADC input or one flash clip (audio_assets.h) from
+ * one position. Up to
+ * SPATIAL_MAX_VOICES can be active; voices SOURCE_R (ADC 2) and
+ * SOURCE_L (ADC 0) are allocated from the start.
+ *
+ * Azimuths are in degrees clockwise from straight ahead (90 = right,
+ * 270 = left). The joystick direction states map onto five of them:
+ * 0 and 4 are 80 degrees right/left, 1 and 3 are 45 degrees, 2 is
+ * straight ahead.
+ */
+
+#ifndef SPATIAL_AUDIO_H
+#define SPATIAL_AUDIO_H
+
+#include <stdint.h>
+
+#include "fix15.h"
+#include "audio_clip.h"
+
+// Size of the voice pool
+#define SPATIAL_MAX_VOICES 8
+
+// Voices playing the right input (ADC 2) and the left input (ADC 0)
+#define SOURCE_R 0
+#define SOURCE_L 1
+
+// Ears, as indexed in azimuth_cue and hrir_table
+#define EAR_LEFT  0
+#define EAR_RIGHT 1
+
+// Rendering modes: interaural level/time differences only (default), or
+// convolution with a head-related impulse response per ear
+#define SPATIAL_MODE_ILD_ITD 0
+#define SPATIAL_MODE_HRTF    1
+
+// The setters below are for one control thread only (the joystick
+// thread on core 0); the block handlers pick changes up at their next
+// block.
+
+// Start a voice playing an ADC channel at azimuth (degrees) and a fix15
+// level. Returns the voice, or -1 if all SPATIAL_MAX_VOICES are in use.
+int spatial_voice_alloc(unsigned int adc_chan, int azimuth, fix15 level) ;
+
+// Start a voice playing a clip (once, or repeating if loop is set).
+// Returns the voice, or -1 if the pool is full.
+int spatial_voice_play(const audio_clip *clip, int loop, int azimuth, fix15 level) ;
+
+// True once both ears have played a non-looping clip voice to the end
+// (it stays allocated, silent, until freed). The calls taking a voice
+// ignore one that is out of range or not allocated.
+int spatial_voice_done(int voice) ;
+
+// Stop an allocated voice (it fades out over one block)
+void spatial_voice_free(int voice) ;
+
+// Number of allocated voices
+int spatial_voices_active(void) ;
+
+// Place a voice at any azimuth (degrees) with a fix15 level
+void spatial_set_azimuth(int voice, int azimuth, fix15 level) ;
+
+// Place a voice at one of the direction states (0-4; others are ignored)
+void spatial_set_direction_state(int voice, int state) ;
+
+// Map a joystick zone (0-4) onto the SOURCE_R/SOURCE_L direction states
+void spatial_set_direction(int direction) ;
+
+// Select the rendering mode (SPATIAL_MODE_*)
+void spatial_set_mode(int mode) ;
+
+// Ramp cue changes over one block (default on). Off makes every change
+// jump at the block boundary, for A/B click measurements.
+void spatial_set_ramp(int enabled) ;
+
+// One block of the right ear (core 0 block handler)
+void spatial_block_core_0(const uint16_t *in, uint16_t *out) ;
+
+// One block of the left ear (core 1 block handler)
+void spatial_block_core_1(const uint16_t *in, uint16_t *out) ;
+
+// One block of both ears (the only block handler, on either core)
+void spatial_block_stereo(const uint16_t *in, uint16_t *out) ;
+
+#endif
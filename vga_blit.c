@@ -0,0 +1,327 @@
+/**
+ * DMA blit engine for the VGA framebuffer (see vga_graphics.h)
+ *
+ * Jobs wait in a queue and run one after the other. A fill or copy is
+ * cut into rows, and each row becomes a control block for DMA channel 6:
+ * its CTRL, WRITE_ADDR, TRANS_COUNT and READ_ADDR_TRIG, in that order
+ * (the channel's alias 3 registers). Channel 7 writes one block into
+ * channel 6 through a 16-byte write ring, which starts the row; when
+ * the row is done, channel 6 chains back to channel 7 for the next one,
+ * the same way the VGA driver's second channel restarts the first. No
+ * pacing: rows go as fast as the bus allows, one byte or one word per
+ * transfer.
+ *
+ * Up to BLIT_CHUNK rows are queued at a time. The chunk ends with a
+ * one-word transfer that sets PIO0 irq flag 3 (free: the VGA machines
+ * use 0 and 1, the vblank interrupt 2), which interrupts the CPU on
+ * PIO0_IRQ_1 to queue the next chunk or job, then a null block that
+ * stops channel 6. Both DMA interrupt lines belong to the audio driver,
+ * so this needs none of them.
+ *
+ * Only whole bytes move by DMA: a fill's odd pixel at either end of a
+ * row is written by the CPU when its chunk is built, and a keyed copy,
+ * which has to test every pixel, runs on the CPU when its turn comes.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include "vga_graphics.h"
+#include "vga_raster.h"
+
+// DMA channels (VGA driver uses 0 and 1, audio 2 to 5)
+#define blit_data_chan 6
+#define blit_ctrl_chan 7
+
+// PIO0 irq flag raised at the end of each chunk
+#define BLIT_PIO_IRQ 3
+
+// Jobs waiting (a power of two) and rows queued per interrupt
+#define BLIT_QUEUE 16
+#define BLIT_CHUNK 64
+
+// Bit masks for the two pixels of a byte (as in vga_raster.c)
+#define TOPMASK 0b11000111
+#define BOTTOMMASK 0b11111000
+
+enum { BLIT_FILL, BLIT_COPY, BLIT_COPY_KEYED } ;
+
+typedef struct {
+    uint8_t kind ;
+    char color ;                // fill color, or the transparent key
+    bool head, tail ;           // fill: odd pixel before / after the bytes
+    unsigned char *dst ;        // first whole byte of the first row
+    const unsigned char *src ;  // copies: first byte of the source
+    int dst_stride, src_stride ;
+    int bytes ;                 // whole bytes per row
+    int rows ;
+    blit_callback_t done ;
+    void *arg ;
+} blit_job ;
+
+// One row for the data channel, in the order of its alias 3 registers
+typedef struct {
+    uint32_t ctrl ;
+    volatile void *write_addr ;
+    uint32_t count ;
+    const volatile void *read_addr ;    // writing it starts the row
+} blit_block ;
+
+static blit_job queue[BLIT_QUEUE] ;
+static volatile uint8_t queue_head, queue_tail ;
+
+// A job is being worked on (in a chunk, or by the CPU)
+static volatile bool running ;
+
+// Next row of the job at the head of the queue
+static int next_row ;
+
+// The chunk: rows, the irq flag write, the null block
+static blit_block blocks[BLIT_CHUNK + 2] ;
+
+// Data channel CTRL values: fill (fixed read) or copy, bytes or words
+static uint32_t ctrl_fill[2], ctrl_copy[2], ctrl_irq ;
+
+// The fill color in every pixel of a word, and the irq flag to raise
+static uint32_t fill_pattern ;
+static const uint32_t irq_word = 1u << BLIT_PIO_IRQ ;
+
+static uint32_t data_ctrl(bool read_increment, enum dma_channel_transfer_size size) {
+    dma_channel_config c = dma_channel_get_default_config(blit_data_chan) ;
+    channel_config_set_transfer_data_size(&c, size) ;
+    channel_config_set_read_increment(&c, read_increment) ;
+    channel_config_set_write_increment(&c, true) ;
+    channel_config_set_chain_to(&c, blit_ctrl_chan) ;
+    channel_config_set_irq_quiet(&c, true) ;
+    return channel_config_get_ctrl_value(&c) ;
+}
+
+// Rows whose addresses, strides and length are all word multiples go a
+// word at a time
+static inline bool job_words(const blit_job *j) {
+    return (((uintptr_t)j->dst | (uintptr_t)j->src | j->dst_stride | j->src_stride | j->bytes) & 3) == 0 ;
+}
+
+// Keyed copy: every source pixel but the key color
+static void run_keyed(const blit_job *j) {
+    for (int r = 0; r < j->rows; r++) {
+        const unsigned char *s = j->src + r * j->src_stride ;
+        unsigned char *d = j->dst + r * j->dst_stride ;
+        for (int b = 0; b < j->bytes; b++) {
+            unsigned char even = s[b] & 7, odd = (s[b] >> 3) & 7, v = d[b] ;
+            if (even != j->color) v = (v & BOTTOMMASK) | even ;
+            if (odd != j->color) v = (v & TOPMASK) | (odd << 3) ;
+            d[b] = v ;
+        }
+    }
+}
+
+// Build and start the next chunk of a fill or copy. False if it needed
+// no DMA (nothing but edge pixels), so the caller carries on.
+static bool start_chunk(const blit_job *j) {
+    int end = next_row + BLIT_CHUNK ;
+    if (end > j->rows) end = j->rows ;
+    bool words = job_words(j) ;
+    int count = words ? j->bytes >> 2 : j->bytes ;
+    int n = 0 ;
+
+    for (int r = next_row; r < end; r++) {
+        unsigned char *d = j->dst + r * j->dst_stride ;
+        if (j->kind == BLIT_FILL) {
+            if (j->head) d[-1] = (d[-1] & TOPMASK) | (j->color << 3) ;
+            if (j->tail) d[j->bytes] = (d[j->bytes] & BOTTOMMASK) | j->color ;
+            if (count) blocks[n++] = (blit_block){ctrl_fill[words], d, count, &fill_pattern} ;
+        }
+        else if (count) {
+            blocks[n++] = (blit_block){ctrl_copy[words], d, count, j->src + r * j->src_stride} ;
+        }
+    }
+    next_row = end ;
+    if (n == 0) return false ;
+
+    blocks[n++] = (blit_block){ctrl_irq, &pio0->irq_force, 1, &irq_word} ;
+    blocks[n] = (blit_block){0, NULL, 0, NULL} ;
+
+    // The control channel loads the first block, which starts the rows
+    dma_channel_set_read_addr(blit_ctrl_chan, blocks, true) ;
+    return true ;
+}
+
+// Work through the queue until a chunk is on its way or it is empty.
+// Finished jobs leave the queue before their callback runs, so the
+// callback may queue more.
+static void run_queue(void) {
+    for (;;) {
+        uint32_t save = save_and_disable_interrupts() ;
+        if (queue_head == queue_tail) {
+            running = false ;
+            restore_interrupts(save) ;
+            return ;
+        }
+        restore_interrupts(save) ;
+
+        blit_job *j = &queue[queue_head % BLIT_QUEUE] ;
+        if (next_row < j->rows) {
+            if (j->kind == BLIT_COPY_KEYED) {
+                run_keyed(j) ;
+                next_row = j->rows ;
+            }
+            else {
+                if (j->kind == BLIT_FILL) fill_pattern = 0x01010101u * (((j->color & 7) << 3) | (j->color & 7)) ;
+                if (start_chunk(j)) return ;
+            }
+        }
+        if (next_row >= j->rows) {
+            blit_callback_t done = j->done ;
+            void *arg = j->arg ;
+            next_row = 0 ;
+            queue_head++ ;
+            if (done) done(arg) ;
+        }
+    }
+}
+
+// End of a chunk
+static void __not_in_flash_func(blit_irq)(void) {
+    pio_interrupt_clear(pio0, BLIT_PIO_IRQ) ;
+    // The control channel may still be loading the null block
+    dma_channel_wait_for_finish_blocking(blit_ctrl_chan) ;
+    run_queue() ;
+}
+
+static bool push_job(const blit_job *job) {
+    bool start = false ;
+    uint32_t save = save_and_disable_interrupts() ;
+    if ((uint8_t)(queue_tail - queue_head) >= BLIT_QUEUE) {
+        restore_interrupts(save) ;
+        return false ;
+    }
+    queue[queue_tail % BLIT_QUEUE] = *job ;
+    queue_tail++ ;
+    if (!running) running = start = true ;
+    restore_interrupts(save) ;
+
+    // Idle: this call runs the job (or its first chunk) itself
+    if (start) run_queue() ;
+    return true ;
+}
+
+void vga_blit_init(void) {
+    ctrl_fill[0] = data_ctrl(false, DMA_SIZE_8) ;
+    ctrl_fill[1] = data_ctrl(false, DMA_SIZE_32) ;
+    ctrl_copy[0] = data_ctrl(true, DMA_SIZE_8) ;
+    ctrl_copy[1] = data_ctrl(true, DMA_SIZE_32) ;
+
+    // The irq flag write: one word, no increments
+    dma_channel_config ci = dma_channel_get_default_config(blit_data_chan) ;
+    channel_config_set_transfer_data_size(&ci, DMA_SIZE_32) ;
+    channel_config_set_read_increment(&ci, false) ;
+    channel_config_set_write_increment(&ci, false) ;
+    channel_config_set_chain_to(&ci, blit_ctrl_chan) ;
+    channel_config_set_irq_quiet(&ci, true) ;
+    ctrl_irq = channel_config_get_ctrl_value(&ci) ;
+
+    // Control channel: one 4-word block into the data channel's alias 3
+    // registers per trigger, wrapping on the 16 bytes they take up
+    dma_channel_config c = dma_channel_get_default_config(blit_ctrl_chan) ;
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32) ;
+    channel_config_set_read_increment(&c, true) ;
+    channel_config_set_write_increment(&c, true) ;
+    channel_config_set_ring(&c, true, 4) ;
+
+    dma_channel_configure(
+        blit_ctrl_chan,                         // Channel to be configured
+        &c,                                     // The configuration we just created
+        &dma_hw->ch[blit_data_chan].al3_ctrl,   // Write address (data channel alias 3)
+        blocks,                                 // Read address (control blocks)
+        4,                                      // One block per trigger
+        false                                   // Don't start immediately.
+    ) ;
+
+    // End of chunk: PIO0 irq flag 3 on PIO0_IRQ_1, below the audio
+    pio_set_irq1_source_enabled(pio0, pis_interrupt0 + BLIT_PIO_IRQ, true) ;
+    irq_set_exclusive_handler(PIO0_IRQ_1, blit_irq) ;
+    irq_set_priority(PIO0_IRQ_1, PICO_LOWEST_IRQ_PRIORITY) ;
+    irq_set_enabled(PIO0_IRQ_1, true) ;
+}
+
+// Clip a rectangle to the draw target and the clip rectangle, and record
+// it as damage. Copies round x down and w up to even pixels (whole
+// bytes) and skip the source pixels clipped away.
+static bool clip_job(blit_job *j, short x, short y, short w, short h, bool whole_bytes) {
+    const vga_target *t = vga_draw_target() ;
+    int x0 = x - t->x, y0 = y - t->y ;
+    int cx0 = t->cx0, cx1 = t->cx1 ;
+    if (whole_bytes) {
+        x0 &= ~1 ;
+        w = (w + 1) & ~1 ;
+        // Copies move whole bytes: the clip rectangle grows to them
+        cx0 &= ~1 ;
+        cx1 = (cx1 + 1) & ~1 ;
+    }
+    if (vga_damage_enabled) vga_damage_add(x0 + t->x, y, w, h) ;
+    int x1 = x0 + w, y1 = y0 + h ;
+    if (x0 < cx0) {
+        if (j->src) j->src += (cx0 - x0) >> 1 ;
+        x0 = cx0 ;
+    }
+    if (y0 < t->cy0) {
+        if (j->src) j->src += (t->cy0 - y0) * j->src_stride ;
+        y0 = t->cy0 ;
+    }
+    if (x1 > cx1) x1 = cx1 ;
+    if (y1 > t->cy1) y1 = t->cy1 ;
+
+    // Nothing to draw: the job stays in line for its callback
+    j->dst_stride = t->w >> 1 ;
+    if (x0 >= x1 || y0 >= y1) {
+        j->dst = t->data ;
+        j->rows = 0 ;
+        return false ;
+    }
+
+    j->head = x0 & 1 ;
+    j->tail = x1 & 1 ;
+    j->dst = &t->data[y0 * j->dst_stride + ((x0 + 1) >> 1)] ;
+    j->bytes = (x1 >> 1) - ((x0 + 1) >> 1) ;
+    j->rows = y1 - y0 ;
+    return true ;
+}
+
+bool blitFill(short x, short y, short w, short h, char color, blit_callback_t done, void *arg) {
+    blit_job j = {.kind = BLIT_FILL, .color = color, .done = done, .arg = arg} ;
+    if (clip_job(&j, x, y, w, h, false)) {
+        // Whole rows of the target are one run of bytes
+        if (j.bytes == j.dst_stride) {
+            j.bytes *= j.rows ;
+            j.rows = 1 ;
+        }
+    }
+    return push_job(&j) ;
+}
+
+bool blitCopy(short x, short y, short w, short h, const unsigned char *src, short src_stride,
+              blit_callback_t done, void *arg) {
+    blit_job j = {.kind = BLIT_COPY, .src = src, .src_stride = src_stride, .done = done, .arg = arg} ;
+    clip_job(&j, x, y, w, h, true) ;
+    return push_job(&j) ;
+}
+
+bool blitCopyKeyed(short x, short y, short w, short h, const unsigned char *src, short src_stride,
+                   char key, blit_callback_t done, void *arg) {
+    blit_job j = {.kind = BLIT_COPY_KEYED, .color = key, .src = src, .src_stride = src_stride,
+                  .done = done, .arg = arg} ;
+    clip_job(&j, x, y, w, h, true) ;
+    return push_job(&j) ;
+}
+
+bool blitBusy(void) {
+    return running ;
+}
+
+void waitBlit(void) {
+    while (running) tight_loop_contents() ;
+}
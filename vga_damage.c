@@ -0,0 +1,229 @@
+/**
+ * Damage tracking and the retained scene (see vga_graphics.h)
+ *
+ * The damage list holds up to VGA_DAMAGE_RECTS screen rectangles. A new
+ * one is dropped if a rectangle already covers it, merged into the first
+ * rectangle whose union with it is no larger than the two apart, or
+ * appended. Once the list is full it grows whichever rectangle grows
+ * least. Primitives record their bounds before the smaller primitives
+ * they are made of, so the rectangle grown last is checked first.
+ *
+ * Rectangles are rounded out to even x (whole framebuffer bytes), so
+ * clipping to them never splits a byte between two redraws.
+ *
+ * Like the primitives, this is memory only (host/vga_bench.c runs it).
+ */
+
+#include <stdbool.h>
+// Header file
+#include "vga_graphics.h"
+#include "vga_raster.h"
+
+// Screen rectangle, x1 and y1 exclusive
+typedef struct {
+    short x0, y0, x1, y1 ;
+} damage_rect ;
+
+// Something in the scene: its bounds and how to draw it
+typedef struct {
+    short x, y, w, h ;
+    scene_draw_t draw ;                 // NULL: free slot
+    void *arg ;
+} scene_item ;
+
+bool vga_damage_enabled ;
+
+static damage_rect damage[VGA_DAMAGE_RECTS] ;
+static int ndamage ;
+static int last_grown ;
+
+static scene_item scene[VGA_SCENE_ITEMS] ;
+static char scene_background = BLACK ;
+
+//========================================================================
+// Damage list
+//========================================================================
+
+static inline int area(const damage_rect *r) {
+    return (r->x1 - r->x0) * (r->y1 - r->y0) ;
+}
+
+static inline bool covers(const damage_rect *r, const damage_rect *d) {
+    return r->x0 <= d->x0 && r->y0 <= d->y0 && r->x1 >= d->x1 && r->y1 >= d->y1 ;
+}
+
+static inline damage_rect union_of(const damage_rect *a, const damage_rect *b) {
+    damage_rect u = {
+        a->x0 < b->x0 ? a->x0 : b->x0, a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1, a->y1 > b->y1 ? a->y1 : b->y1,
+    } ;
+    return u ;
+}
+
+// Worth merging: the union redraws no more pixels than the two apart
+static inline bool cheap_union(const damage_rect *a, const damage_rect *b, damage_rect *u) {
+    *u = union_of(a, b) ;
+    return area(u) <= area(a) + area(b) ;
+}
+
+// Rectangle i has grown: fold in any others it now merges with
+static void settle(int i) {
+    bool merged = true ;
+    while (merged) {
+        merged = false ;
+        for (int j = 0; j < ndamage; j++) {
+            damage_rect u ;
+            if (j == i || !cheap_union(&damage[i], &damage[j], &u)) continue ;
+            damage[i] = u ;
+            // Fill the hole with the last rectangle
+            damage[j] = damage[--ndamage] ;
+            if (i == ndamage) i = j ;
+            merged = true ;
+            break ;
+        }
+    }
+    last_grown = i ;
+}
+
+void vga_damage_add(int x, int y, int w, int h) {
+    // On screen, rounded out to whole bytes
+    int x0 = x < 0 ? 0 : x & ~1 ;
+    int y0 = y < 0 ? 0 : y ;
+    int x1 = x + w > VGA_WIDTH ? VGA_WIDTH : (x + w + 1) & ~1 ;
+    int y1 = y + h > VGA_HEIGHT ? VGA_HEIGHT : y + h ;
+    if (x0 >= x1 || y0 >= y1) return ;
+    damage_rect d = {x0, y0, x1, y1} ;
+
+    if (ndamage && covers(&damage[last_grown], &d)) return ;
+
+    for (int i = 0; i < ndamage; i++) {
+        damage_rect u ;
+        if (covers(&damage[i], &d)) {
+            last_grown = i ;
+            return ;
+        }
+        if (cheap_union(&damage[i], &d, &u)) {
+            damage[i] = u ;
+            settle(i) ;
+            return ;
+        }
+    }
+
+    if (ndamage < VGA_DAMAGE_RECTS) {
+        damage[ndamage] = d ;
+        last_grown = ndamage++ ;
+        return ;
+    }
+
+    // Full: grow the rectangle that grows least
+    int best = 0, best_growth = 0 ;
+    for (int i = 0; i < ndamage; i++) {
+        damage_rect u = union_of(&damage[i], &d) ;
+        int growth = area(&u) - area(&damage[i]) ;
+        if (i == 0 || growth < best_growth) {
+            best = i ;
+            best_growth = growth ;
+        }
+    }
+    damage[best] = union_of(&damage[best], &d) ;
+    settle(best) ;
+}
+
+void setDamageTracking(bool enabled) {
+    vga_damage_enabled = enabled ;
+}
+
+void addDamage(short x, short y, short w, short h) {
+    vga_damage_add(x, y, w, h) ;
+}
+
+void clearDamage(void) {
+    ndamage = 0 ;
+    last_grown = 0 ;
+}
+
+int damageCount(void) {
+    return ndamage ;
+}
+
+void getDamage(int i, short *x, short *y, short *w, short *h) {
+    *x = damage[i].x0 ;
+    *y = damage[i].y0 ;
+    *w = damage[i].x1 - damage[i].x0 ;
+    *h = damage[i].y1 - damage[i].y0 ;
+}
+
+//========================================================================
+// Retained scene
+//========================================================================
+
+int sceneAdd(short x, short y, short w, short h, scene_draw_t draw, void *arg) {
+    for (int id = 0; id < VGA_SCENE_ITEMS; id++) {
+        if (scene[id].draw) continue ;
+        scene[id] = (scene_item){x, y, w, h, draw, arg} ;
+        vga_damage_add(x, y, w, h) ;
+        return id ;
+    }
+    return -1 ;
+}
+
+// An id sceneAdd handed out whose item has not been removed since
+static inline bool scene_live(int id) {
+    return id >= 0 && id < VGA_SCENE_ITEMS && scene[id].draw ;
+}
+
+void sceneMove(int id, short x, short y, short w, short h) {
+    if (!scene_live(id)) return ;
+    scene_item *s = &scene[id] ;
+    vga_damage_add(s->x, s->y, s->w, s->h) ;
+    s->x = x ;
+    s->y = y ;
+    s->w = w ;
+    s->h = h ;
+    vga_damage_add(x, y, w, h) ;
+}
+
+void sceneInvalidate(int id) {
+    if (!scene_live(id)) return ;
+    scene_item *s = &scene[id] ;
+    vga_damage_add(s->x, s->y, s->w, s->h) ;
+}
+
+void sceneRemove(int id) {
+    if (!scene_live(id)) return ;
+    sceneInvalidate(id) ;
+    scene[id].draw = 0 ;
+}
+
+void sceneSetBackground(char color) {
+    scene_background = color ;
+    vga_damage_add(0, 0, VGA_WIDTH, VGA_HEIGHT) ;
+}
+
+void sceneRedraw(void) {
+    // Redrawing is not new damage
+    bool tracking = vga_damage_enabled ;
+    vga_damage_enabled = false ;
+
+    // Each rectangle is redrawn clipped to itself; the caller's clip
+    // rectangle comes back afterwards
+    short clip_x, clip_y, clip_w, clip_h ;
+    getClipRect(&clip_x, &clip_y, &clip_w, &clip_h) ;
+
+    for (int i = 0; i < ndamage; i++) {
+        const damage_rect *d = &damage[i] ;
+        setClipRect(d->x0, d->y0, d->x1 - d->x0, d->y1 - d->y0) ;
+        fillRect(d->x0, d->y0, d->x1 - d->x0, d->y1 - d->y0, scene_background) ;
+        for (int id = 0; id < VGA_SCENE_ITEMS; id++) {
+            const scene_item *s = &scene[id] ;
+            if (!s->draw) continue ;
+            if (s->x >= d->x1 || s->x + s->w <= d->x0) continue ;
+            if (s->y >= d->y1 || s->y + s->h <= d->y0) continue ;
+            s->draw(s->x, s->y, s->w, s->h, s->arg) ;
+        }
+    }
+    setClipRect(clip_x, clip_y, clip_w, clip_h) ;
+    clearDamage() ;
+
+    vga_damage_enabled = tracking ;
+}
@@ -12,8 +12,13 @@
  *
  * RESOURCES USED
  *  - PIO state machines 0, 1, and 2 on PIO instance 0
- *  - DMA channels 0, 1, 2, and 3
- *  - 153.6 kBytes of RAM (for pixel color data)
+ *  - DMA channels 0 and 1 (scanout), 6 and 7 (blits)
+ *  - PIO0_IRQ_0 (vertical blanking) and PIO0_IRQ_1 (blits), lowest priority
+ *  - 153.6 kBytes of RAM (for pixel color data), plus the back buffer
+ *    and the glyph cache (4.6 kBytes)
+ *  - or, with VGA_MODE_SCANLINE (tiles and sprites, see vga_tiles.h):
+ *    DMA channels 0 and 1, PIO0_IRQ_0 (line interrupt) at the highest
+ *    priority and 640 bytes of line buffers; no blits
  *
  * NOTE
  *  - This is a translation of the display primitives
@@ -21,6 +26,38 @@
  *
  */
 
+#include <stdbool.h>
+
+// Video memory, chosen at build time (VGA_MODE in CMakeLists.txt): a
+// framebuffer drawn with the primitives below (default), or a tile map
+// and sprites composed a line at a time (vga_tiles.h), which leaves the
+// framebuffer's 150 kBytes to the rest of the program
+#define VGA_MODE_FRAMEBUFFER 0
+#define VGA_MODE_SCANLINE    1
+
+#ifndef VGA_MODE
+#define VGA_MODE VGA_MODE_FRAMEBUFFER
+#endif
+
+// Off-screen back buffer, in bytes (2 pixels each). The default holds a
+// quarter of the screen (640x120); a second full framebuffer would not
+// fit next to the first and the audio buffers.
+#ifndef VGA_BACK_BUFFER_BYTES
+#define VGA_BACK_BUFFER_BYTES 38400
+#endif
+
+// Damaged screen rectangles tracked at once, and items in the scene
+#ifndef VGA_DAMAGE_RECTS
+#define VGA_DAMAGE_RECTS 16
+#endif
+#ifndef VGA_SCENE_ITEMS
+#define VGA_SCENE_ITEMS 32
+#endif
+
+// Glyphs kept expanded to their text size (36 bytes each)
+#ifndef VGA_GLYPH_CACHE
+#define VGA_GLYPH_CACHE 128
+#endif
 
 // Give the I/O pins that we're using some names that make sense - usable in main()
 enum vga_pins {HSYNC=16, VSYNC, RED_PIN, GREEN_PIN, BLUE_PIN} ;
@@ -49,4 +86,72 @@ void setTextColor2(char c, char bg);
 void setTextSize(unsigned char s);
 void setTextWrap(char w);
 void tft_write(unsigned char c) ;
-void writeString(char* str) ;
\ No newline at end of file
+void writeString(char* str) ;
+
+// Tear-free redraws. beginBackBuffer() points every primitive above at
+// an off-screen copy of one screen rectangle (x and w are rounded to
+// even pixels, h is cut to what VGA_BACK_BUFFER_BYTES holds; drawing
+// outside it is dropped). flipBackBuffer() goes back to drawing on the
+// screen and has the rectangle copied there in the next vertical blank;
+// waitForFlip() blocks until it has been, flipPending() polls (for
+// protothreads). beginBackBuffer() waits for a pending flip itself.
+void beginBackBuffer(short x, short y, short w, short h) ;
+void flipBackBuffer(void) ;
+bool flipPending(void) ;
+void waitForFlip(void) ;
+
+// DMA blits, queued and run in order without the CPU. Each clips to the
+// draw target as it is when queued (the screen, or the back buffer: let
+// the blits finish before flipping it). done(arg), if given, runs once
+// the job is finished: in a low-priority interrupt, or in the call that
+// queued it if it needed no DMA. Every call returns false, queuing
+// nothing, if the queue is full. Call them from the core that ran
+// initVGA.
+//  - blitFill: a rectangle of one color
+//  - blitCopy: w x h pixels from src (packed like the framebuffer, rows
+//    src_stride bytes apart) to (x, y). x and w are rounded to even
+//    pixels; src must not overlap the destination.
+//  - blitCopyKeyed: the same, leaving pixels of color key untouched
+//    (this one runs on the CPU, when its turn comes)
+typedef void (*blit_callback_t)(void *arg) ;
+bool blitFill(short x, short y, short w, short h, char color, blit_callback_t done, void *arg) ;
+bool blitCopy(short x, short y, short w, short h, const unsigned char *src, short src_stride,
+              blit_callback_t done, void *arg) ;
+bool blitCopyKeyed(short x, short y, short w, short h, const unsigned char *src, short src_stride,
+                   char key, blit_callback_t done, void *arg) ;
+bool blitBusy(void) ;
+void waitBlit(void) ;
+
+// Clip rectangle: every primitive and blit (queued after the call) draws
+// only inside it, on the screen or the back buffer. In screen pixels.
+void setClipRect(short x, short y, short w, short h) ;
+void clearClipRect(void) ;
+// The clip rectangle now (on screen: setClipRect clamps it)
+void getClipRect(short *x, short *y, short *w, short *h) ;
+
+// Damage tracking. While it is on, the screen bounds of everything drawn
+// are merged into at most VGA_DAMAGE_RECTS rectangles (x rounded out to
+// even pixels). addDamage() marks a rectangle by hand, tracking or not.
+// damageCount() and getDamage() read the list; clearDamage() empties it.
+void setDamageTracking(bool enabled) ;
+void addDamage(short x, short y, short w, short h) ;
+void clearDamage(void) ;
+int damageCount(void) ;
+void getDamage(int i, short *x, short *y, short *w, short *h) ;
+
+// Retained scene: up to VGA_SCENE_ITEMS things to draw, each a bounding
+// rectangle and a function that draws it there with the primitives.
+// Adding, moving, invalidating (its look changed) and removing an item
+// mark its old and new bounds as damaged. sceneRedraw() then redraws
+// only the damaged rectangles: each is cleared to the background color
+// and clipped, and the items overlapping it are drawn in id order
+// (lowest underneath). It empties the damage list. sceneAdd() returns
+// the item's id, or -1 if the scene is full; the other calls ignore -1
+// and the ids of removed items.
+typedef void (*scene_draw_t)(short x, short y, short w, short h, void *arg) ;
+int sceneAdd(short x, short y, short w, short h, scene_draw_t draw, void *arg) ;
+void sceneMove(int id, short x, short y, short w, short h) ;
+void sceneInvalidate(int id) ;
+void sceneRemove(int id) ;
+void sceneSetBackground(char color) ;
+void sceneRedraw(void) ;
\ No newline at end of file
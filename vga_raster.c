@@ -0,0 +1,737 @@
+/**
+ * Drawing primitives for the VGA driver (see vga_graphics.h)
+ *
+ * Everything here works on memory only: the framebuffer that
+ * vga_graphics.c streams to the screen, or the back buffer. No SDK
+ * headers, so the host build runs the same code (host/vga_bench.c).
+ *
+ * Pixels are packed two per byte, the even pixel in bits 0-2 and the
+ * odd one in bits 3-5. Rectangles and lines are filled a span at a
+ * time: a masked write for an odd pixel at either end, memset for the
+ * whole bytes between. Text is drawn a glyph row at a time from glyphs
+ * expanded to the text size (see the glyph cache below).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+// Header file
+#include "vga_graphics.h"
+#include "vga_raster.h"
+// Font file
+#include "glcdfont.c"
+
+// Pixel color array that is DMA's to the PIO machines.
+// Note that this array is automatically initialized to all 0's (black)
+unsigned char vga_data_array[VGA_BYTES];
+
+// Off-screen back buffer (see beginBackBuffer in vga_graphics.h)
+static unsigned char back_buffer[VGA_BACK_BUFFER_BYTES] ;
+
+static vga_target screen_target = {vga_data_array, 0, 0, VGA_WIDTH, VGA_HEIGHT,
+                                   0, 0, VGA_WIDTH, VGA_HEIGHT} ;
+vga_target vga_back_target ;
+static vga_target *target = &screen_target ;
+
+// Clip rectangle (screen coordinates, x1 and y1 exclusive)
+static short clip_x0, clip_y0, clip_x1 = VGA_WIDTH, clip_y1 = VGA_HEIGHT ;
+
+// Record the bounds of a primitive as damaged (vga_damage.c). The
+// primitives it is made of fall inside them, so vga_damage_add finds
+// them already covered.
+static inline void damage(int x, int y, int w, int h) {
+    if (vga_damage_enabled) vga_damage_add(x, y, w, h) ;
+}
+
+// The part of the target that the clip rectangle leaves, in target
+// coordinates
+static void update_clip(vga_target *t) {
+    t->cx0 = clip_x0 > t->x ? clip_x0 - t->x : 0 ;
+    t->cy0 = clip_y0 > t->y ? clip_y0 - t->y : 0 ;
+    t->cx1 = clip_x1 - t->x < t->w ? clip_x1 - t->x : t->w ;
+    t->cy1 = clip_y1 - t->y < t->h ? clip_y1 - t->y : t->h ;
+}
+
+volatile bool vga_flip_pending ;
+
+// Bit masks for drawPixel routine
+#define TOPMASK 0b11000111
+#define BOTTOMMASK 0b11111000
+
+// For drawLine
+#define swap(a, b) { short t = a; a = b; b = t; }
+
+// For writing text
+#define tabspace 4 // number of spaces for a tab
+
+// For accessing the font library
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+
+// For drawing characters
+unsigned short cursor_y, cursor_x, textsize ;
+char textcolor, textbgcolor, wrap;
+
+// Screen width/height
+#define _width VGA_WIDTH
+#define _height VGA_HEIGHT
+
+// A function for drawing a pixel with a specified color.
+// Note that because information is passed to the PIO state machines through
+// a DMA channel, we only need to modify the contents of the array and the
+// pixels will be automatically updated on the screen.
+void drawPixel(short x, short y, char color) {
+    // Off the 640x480 display: clipped, like the span primitives
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return ;
+
+    damage(x, y, 1, 1) ;
+
+    // Relative to the draw target, which may be a smaller window, and
+    // inside the clip rectangle
+    x -= target->x ;
+    y -= target->y ;
+    if (x < target->cx0 || x >= target->cx1) return ;
+    if (y < target->cy0 || y >= target->cy1) return ;
+
+    // Which pixel is it?
+    int pixel = ((target->w * y) + x) ;
+    unsigned char *data = target->data ;
+
+    // Is this pixel stored in the first 3 bits
+    // of the vga data array index, or the second
+    // 3 bits? Check, then mask.
+    if (pixel & 1) {
+        data[pixel>>1] = (data[pixel>>1] & TOPMASK) | (color << 3) ;
+    }
+    else {
+        data[pixel>>1] = (data[pixel>>1] & BOTTOMMASK) | (color) ;
+    }
+}
+
+void beginBackBuffer(short x, short y, short w, short h) {
+    // The previous flip must be on screen before the buffer is reused
+    waitForFlip() ;
+
+    // Even x and w keep both pixels of every byte in the same window
+    if (x < 0) x = 0 ;
+    if (y < 0) y = 0 ;
+    x &= ~1 ;
+    w = (w + 1) & ~1 ;
+    if (w > 640 - x) w = 640 - x ;
+    if (h > 480 - y) h = 480 - y ;
+    if (w <= 0 || h <= 0) return ;
+    if (h > VGA_BACK_BUFFER_BYTES / (w >> 1)) h = VGA_BACK_BUFFER_BYTES / (w >> 1) ;
+
+    // Start from what's on screen, so partial redraws compose
+    vga_back_target = (vga_target){back_buffer, x, y, w, h, 0, 0, 0, 0} ;
+    update_clip(&vga_back_target) ;
+    int row_bytes = w >> 1 ;
+    for (int j = 0; j < h; j++) {
+        memcpy(&back_buffer[j * row_bytes], &vga_data_array[(640 * (y + j) + x) >> 1], row_bytes) ;
+    }
+    target = &vga_back_target ;
+}
+
+void flipBackBuffer(void) {
+    if (target != &vga_back_target) return ;
+    target = &screen_target ;
+    update_clip(target) ;
+    vga_flip_pending = true ;
+}
+
+void setClipRect(short x, short y, short w, short h) {
+    clip_x0 = x < 0 ? 0 : x ;
+    clip_y0 = y < 0 ? 0 : y ;
+    clip_x1 = x + w > VGA_WIDTH ? VGA_WIDTH : x + w ;
+    clip_y1 = y + h > VGA_HEIGHT ? VGA_HEIGHT : y + h ;
+    update_clip(target) ;
+}
+
+void clearClipRect(void) {
+    setClipRect(0, 0, VGA_WIDTH, VGA_HEIGHT) ;
+}
+
+void getClipRect(short *x, short *y, short *w, short *h) {
+    *x = clip_x0 ;
+    *y = clip_y0 ;
+    *w = clip_x1 - clip_x0 ;
+    *h = clip_y1 - clip_y0 ;
+}
+
+const vga_target *vga_draw_target(void) {
+    return target ;
+}
+
+bool flipPending(void) {
+    return vga_flip_pending ;
+}
+
+void waitForFlip(void) {
+    while (vga_flip_pending) ;
+}
+
+// Fill pixels x0 to x1 - 1 of a target row
+static inline void fill_span(unsigned char *row, int x0, int x1, char color) {
+    if (x0 & 1) {
+        row[x0>>1] = (row[x0>>1] & TOPMASK) | (color << 3) ;
+        x0++ ;
+    }
+    if (x1 & 1) {
+        x1-- ;
+        row[x1>>1] = (row[x1>>1] & BOTTOMMASK) | (color) ;
+    }
+    // Whole bytes: a call to memset only pays off for long spans
+    int n = (x1 - x0) >> 1 ;
+    unsigned char pair = (color << 3) | color ;
+    unsigned char *p = &row[x0>>1] ;
+    if (n >= 16) memset(p, pair, n) ;
+    else while (n-- > 0) *p++ = pair ;
+}
+
+// Clip a rectangle in screen coordinates to the draw target and the
+// clip rectangle, giving
+// target-relative corners (x1, y1 exclusive). False if nothing is left.
+static inline bool clip_rect(int x, int y, int w, int h, int *x0, int *y0, int *x1, int *y1) {
+    *x0 = x - target->x ;
+    *y0 = y - target->y ;
+    *x1 = *x0 + w ;
+    *y1 = *y0 + h ;
+    if (*x0 < target->cx0) *x0 = target->cx0 ;
+    if (*y0 < target->cy0) *y0 = target->cy0 ;
+    if (*x1 > target->cx1) *x1 = target->cx1 ;
+    if (*y1 > target->cy1) *y1 = target->cy1 ;
+    return (*x0 < *x1) && (*y0 < *y1) ;
+}
+
+void drawVLine(short x, short y, short h, char color) {
+    int x0, y0, x1, y1 ;
+    damage(x, y, 1, h) ;
+    if (!clip_rect(x, y, 1, h, &x0, &y0, &x1, &y1)) return ;
+
+    // Same half of every byte down the column
+    int stride = target->w >> 1 ;
+    unsigned char *p = &target->data[y0 * stride + (x0 >> 1)] ;
+    unsigned char mask = (x0 & 1) ? TOPMASK : BOTTOMMASK ;
+    unsigned char bits = (x0 & 1) ? (color << 3) : color ;
+    for (int j = y0; j < y1; j++) {
+        *p = (*p & mask) | bits ;
+        p += stride ;
+    }
+}
+
+void drawHLine(short x, short y, short w, char color) {
+    fillRect(x, y, w, 1, color) ;
+}
+
+// Bresenham's algorithm - thx wikipedia and thx Bruce!
+void drawLine(short x0, short y0, short x1, short y1, char color) {
+/* Draw a straight line from (x0,y0) to (x1,y1) with given color
+ * Parameters:
+ *      x0: x-coordinate of starting point of line. The x-coordinate of
+ *          the top-left of the screen is 0. It increases to the right.
+ *      y0: y-coordinate of starting point of line. The y-coordinate of
+ *          the top-left of the screen is 0. It increases to the bottom.
+ *      x1: x-coordinate of ending point of line. The x-coordinate of
+ *          the top-left of the screen is 0. It increases to the right.
+ *      y1: y-coordinate of ending point of line. The y-coordinate of
+ *          the top-left of the screen is 0. It increases to the bottom.
+ *      color: 3-bit color value for line
+ */
+      damage(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, abs(x1 - x0) + 1, abs(y1 - y0) + 1) ;
+      short steep = abs(y1 - y0) > abs(x1 - x0);
+      if (steep) {
+        swap(x0, y0);
+        swap(x1, y1);
+      }
+
+      if (x0 > x1) {
+        swap(x0, x1);
+        swap(y0, y1);
+      }
+
+      short dx, dy;
+      dx = x1 - x0;
+      dy = abs(y1 - y0);
+
+      short err = dx / 2;
+      short ystep;
+
+      if (y0 < y1) {
+        ystep = 1;
+      } else {
+        ystep = -1;
+      }
+
+      for (; x0<=x1; x0++) {
+        if (steep) {
+          drawPixel(y0, x0, color);
+        } else {
+          drawPixel(x0, y0, color);
+        }
+        err -= dy;
+        if (err < 0) {
+          y0 += ystep;
+          err += dx;
+        }
+      }
+}
+
+// Draw a rectangle
+void drawRect(short x, short y, short w, short h, char color) {
+/* Draw a rectangle outline with top left vertex (x,y), width w
+ * and height h at given color
+ * Parameters:
+ *      x:  x-coordinate of top-left vertex. The x-coordinate of
+ *          the top-left of the screen is 0. It increases to the right.
+ *      y:  y-coordinate of top-left vertex. The y-coordinate of
+ *          the top-left of the screen is 0. It increases to the bottom.
+ *      w:  width of the rectangle
+ *      h:  height of the rectangle
+ *      color:  16-bit color of the rectangle outline
+ * Returns: Nothing
+ */
+  damage(x, y, w, h) ;
+  drawHLine(x, y, w, color);
+  drawHLine(x, y+h-1, w, color);
+  drawVLine(x, y, h, color);
+  drawVLine(x+w-1, y, h, color);
+}
+
+void drawCircle(short x0, short y0, short r, char color) {
+/* Draw a circle outline with center (x0,y0) and radius r, with given color
+ * Parameters:
+ *      x0: x-coordinate of center of circle. The top-left of the screen
+ *          has x-coordinate 0 and increases to the right
+ *      y0: y-coordinate of center of circle. The top-left of the screen
+ *          has y-coordinate 0 and increases to the bottom
+ *      r:  radius of circle
+ *      color: 16-bit color value for the circle. Note that the circle
+ *          isn't filled. So, this is the color of the outline of the circle
+ * Returns: Nothing
+ */
+  damage(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1) ;
+  short f = 1 - r;
+  short ddF_x = 1;
+  short ddF_y = -2 * r;
+  short x = 0;
+  short y = r;
+
+  drawPixel(x0  , y0+r, color);
+  drawPixel(x0  , y0-r, color);
+  drawPixel(x0+r, y0  , color);
+  drawPixel(x0-r, y0  , color);
+
+  while (x<y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+
+    drawPixel(x0 + x, y0 + y, color);
+    drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color);
+    drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color);
+    drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color);
+    drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+void drawCircleHelper( short x0, short y0, short r, unsigned char cornername, char color) {
+// Helper function for drawing circles and circular objects
+  damage(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1) ;
+  short f     = 1 - r;
+  short ddF_x = 1;
+  short ddF_y = -2 * r;
+  short x     = 0;
+  short y     = r;
+
+  while (x<y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f     += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f     += ddF_x;
+    if (cornername & 0x4) {
+      drawPixel(x0 + x, y0 + y, color);
+      drawPixel(x0 + y, y0 + x, color);
+    }
+    if (cornername & 0x2) {
+      drawPixel(x0 + x, y0 - y, color);
+      drawPixel(x0 + y, y0 - x, color);
+    }
+    if (cornername & 0x8) {
+      drawPixel(x0 - y, y0 + x, color);
+      drawPixel(x0 - x, y0 + y, color);
+    }
+    if (cornername & 0x1) {
+      drawPixel(x0 - y, y0 - x, color);
+      drawPixel(x0 - x, y0 - y, color);
+    }
+  }
+}
+
+void fillCircle(short x0, short y0, short r, char color) {
+/* Draw a filled circle with center (x0,y0) and radius r, with given color
+ * Parameters:
+ *      x0: x-coordinate of center of circle. The top-left of the screen
+ *          has x-coordinate 0 and increases to the right
+ *      y0: y-coordinate of center of circle. The top-left of the screen
+ *          has y-coordinate 0 and increases to the bottom
+ *      r:  radius of circle
+ *      color: 16-bit color value for the circle
+ * Returns: Nothing
+ */
+  damage(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1) ;
+  drawVLine(x0, y0-r, 2*r+1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+}
+
+void fillCircleHelper(short x0, short y0, short r, unsigned char cornername, short delta, char color) {
+// Helper function for drawing filled circles
+  damage(x0 - r, y0 - r, 2 * r + 1, 2 * r + 1 + delta) ;
+  short f     = 1 - r;
+  short ddF_x = 1;
+  short ddF_y = -2 * r;
+  short x     = 0;
+  short y     = r;
+
+  while (x<y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f     += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f     += ddF_x;
+
+    if (cornername & 0x1) {
+      drawVLine(x0+x, y0-y, 2*y+1+delta, color);
+      drawVLine(x0+y, y0-x, 2*x+1+delta, color);
+    }
+    if (cornername & 0x2) {
+      drawVLine(x0-x, y0-y, 2*y+1+delta, color);
+      drawVLine(x0-y, y0-x, 2*x+1+delta, color);
+    }
+  }
+}
+
+// Draw a rounded rectangle
+void drawRoundRect(short x, short y, short w, short h, short r, char color) {
+/* Draw a rounded rectangle outline with top left vertex (x,y), width w,
+ * height h and radius of curvature r at given color
+ * Parameters:
+ *      x:  x-coordinate of top-left vertex. The x-coordinate of
+ *          the top-left of the screen is 0. It increases to the right.
+ *      y:  y-coordinate of top-left vertex. The y-coordinate of
+ *          the top-left of the screen is 0. It increases to the bottom.
+ *      w:  width of the rectangle
+ *      h:  height of the rectangle
+ *      color:  16-bit color of the rectangle outline
+ * Returns: Nothing
+ */
+  damage(x, y, w, h) ;
+  // smarter version
+  drawHLine(x+r  , y    , w-2*r, color); // Top
+  drawHLine(x+r  , y+h-1, w-2*r, color); // Bottom
+  drawVLine(x    , y+r  , h-2*r, color); // Left
+  drawVLine(x+w-1, y+r  , h-2*r, color); // Right
+  // draw four corners
+  drawCircleHelper(x+r    , y+r    , r, 1, color);
+  drawCircleHelper(x+w-r-1, y+r    , r, 2, color);
+  drawCircleHelper(x+w-r-1, y+h-r-1, r, 4, color);
+  drawCircleHelper(x+r    , y+h-r-1, r, 8, color);
+}
+
+// Fill a rounded rectangle
+void fillRoundRect(short x, short y, short w, short h, short r, char color) {
+  damage(x, y, w, h) ;
+  // smarter version
+  fillRect(x+r, y, w-2*r, h, color);
+
+  // draw four corners
+  fillCircleHelper(x+w-r-1, y+r, r, 1, h-2*r-1, color);
+  fillCircleHelper(x+r    , y+r, r, 2, h-2*r-1, color);
+}
+
+
+// fill a rectangle
+void fillRect(short x, short y, short w, short h, char color) {
+/* Draw a filled rectangle with starting top-left vertex (x,y),
+ *  width w and height h with given color
+ * Parameters:
+ *      x:  x-coordinate of top-left vertex; top left of screen is x=0
+ *              and x increases to the right
+ *      y:  y-coordinate of top-left vertex; top left of screen is y=0
+ *              and y increases to the bottom
+ *      w:  width of rectangle
+ *      h:  height of rectangle
+ *      color:  3-bit color value
+ * Returns:     Nothing
+ */
+
+  // Clipped to the draw target (the screen, or the back buffer)
+  int x0, y0, x1, y1 ;
+  damage(x, y, w, h) ;
+  if (!clip_rect(x, y, w, h, &x0, &y0, &x1, &y1)) return ;
+
+  // One span per row
+  int stride = target->w >> 1 ;
+  unsigned char *row = &target->data[y0 * stride] ;
+  for (int j = y0; j < y1; j++) {
+    fill_span(row, x0, x1, color) ;
+    row += stride ;
+  }
+}
+
+//========================================================================
+// Glyph cache
+//========================================================================
+
+// Largest text size drawn from the cache: a glyph row, shifted by one
+// pixel for odd x, fits in 32 bits. Larger text is drawn with fillRect.
+#define GLYPH_MAX_SIZE 5
+
+// One character at one size: each of its 8 font rows as a mask of the
+// pixels set, 6 * size bits with bit 0 leftmost. Each row is drawn size
+// times down.
+typedef struct {
+    unsigned char c, size ;             // size 0: empty
+    uint32_t rows[8] ;
+} glyph ;
+
+// Direct-mapped on character and size
+static glyph glyph_cache[VGA_GLYPH_CACHE] ;
+
+// The bits of a framebuffer byte that two pixels cover: none, the even
+// one, the odd one, both
+static const unsigned char pair_mask[4] = {0x00, 0x07, 0x38, 0x3f} ;
+
+static const glyph *get_glyph(unsigned char c, unsigned char size) {
+    glyph *g = &glyph_cache[(c + size * 61) % VGA_GLYPH_CACHE] ;
+    if (g->c == c && g->size == size) return g ;
+
+    // Every font pixel becomes size pixels across
+    uint32_t wide = (1u << size) - 1 ;
+    for (int j = 0; j < 8; j++) {
+        uint32_t row = 0 ;
+        for (int i = 0; i < 5; i++) {
+            if ((pgm_read_byte(font + (c * 5) + i) >> j) & 1) row |= wide << (i * size) ;
+        }
+        g->rows[j] = row ;
+    }
+    g->c = c ;
+    g->size = size ;
+    return g ;
+}
+
+// Draw a cached glyph at target pixel (x, y), which must fit inside the
+// clip window. Each font row becomes a row of byte writes, repeated
+// size times down: whole bytes of an opaque glyph are stored outright,
+// edge bytes and transparent ones keep the pixels the glyph leaves.
+static void draw_glyph(int x, int y, const glyph *g, char color, char bg) {
+    int size = g->size ;
+    int shift = x & 1 ;
+    int bytes = (6 * size + shift + 1) >> 1 ;
+    uint32_t cover = ((1u << (6 * size)) - 1) << shift ;
+    unsigned char fg2 = color | (color << 3), bg2 = bg | (bg << 3) ;
+    bool opaque = (bg != color) ;
+    // Bytes lo to hi - 1 are stored whole: an opaque glyph covers every
+    // pixel of them, and only its first and last bytes can be shared
+    // with the neighbours. A transparent glyph merges every byte.
+    int lo = opaque ? shift : bytes ;
+    int hi = opaque ? (6 * size + shift) >> 1 : bytes ;
+
+    int stride = target->w >> 1 ;
+    unsigned char *row = &target->data[y * stride + (x >> 1)] ;
+    unsigned char keep[GLYPH_MAX_SIZE * 3 + 1], set[GLYPH_MAX_SIZE * 3 + 1] ;
+
+    for (int j = 0; j < 8; j++) {
+        // The row's bytes: dst = (dst & keep) | set
+        uint32_t bits = g->rows[j] << shift, area = cover ;
+        for (int k = 0; k < bytes; k++) {
+            unsigned char on = pair_mask[bits & 3], in = pair_mask[area & 3] ;
+            bits >>= 2 ;
+            area >>= 2 ;
+            if (opaque) {
+                keep[k] = (unsigned char)~in ;
+                set[k] = (fg2 & on) | (bg2 & in & ~on) ;
+            } else {
+                keep[k] = (unsigned char)~on ;
+                set[k] = fg2 & on ;
+            }
+        }
+        for (int n = 0; n < size; n++) {
+            for (int k = 0; k < lo; k++) row[k] = (row[k] & keep[k]) | set[k] ;
+            for (int k = lo; k < hi; k++) row[k] = set[k] ;
+            for (int k = hi; k < bytes; k++) row[k] = (row[k] & keep[k]) | set[k] ;
+            row += stride ;
+        }
+    }
+}
+
+// Text layout for one call: the glyph size, and the screen positions at
+// which a glyph lies wholly inside the clip window (drawn from the
+// cache; anything else goes pixel by pixel)
+typedef struct {
+    int size, w, h ;
+    int left, right, top, bottom ;
+} text_layout ;
+
+static void layout_text(text_layout *l, int size) {
+    l->size = size ;
+    l->w = 6 * size ;
+    l->h = 8 * size ;
+    l->left = target->x + target->cx0 ;
+    l->right = target->x + target->cx1 - l->w ;
+    l->top = target->y + target->cy0 ;
+    l->bottom = target->y + target->cy1 - l->h ;
+    // Too big to cache: no glyph fits
+    if (size > GLYPH_MAX_SIZE) l->right = l->left - 1 ;
+}
+
+static void draw_char_pixels(short x, short y, unsigned char c, char color, char bg, unsigned char size) ;
+
+static inline void layout_char(const text_layout *l, short x, short y, unsigned char c, char color, char bg) {
+    if (x >= l->left && x <= l->right && y >= l->top && y <= l->bottom) {
+        damage(x, y, l->w, l->h) ;
+        draw_glyph(x - target->x, y - target->y, get_glyph(c, l->size), color, bg) ;
+    } else {
+        draw_char_pixels(x, y, c, color, bg, l->size) ;
+    }
+}
+
+// Draw a character
+void drawChar(short x, short y, unsigned char c, char color, char bg, unsigned char size) {
+    text_layout l ;
+    layout_text(&l, size) ;
+    layout_char(&l, x, y, c, color, bg) ;
+}
+
+// A character that is not wholly inside the clip window, or too big for
+// the glyph cache, one font pixel at a time
+static void draw_char_pixels(short x, short y, unsigned char c, char color, char bg, unsigned char size) {
+    char i, j;
+  if((x >= _width)            || // Clip right
+     (y >= _height)           || // Clip bottom
+     ((x + 6 * size - 1) < 0) || // Clip left
+     ((y + 8 * size - 1) < 0))   // Clip top
+    return;
+  damage(x, y, 6 * size, 8 * size) ;
+
+  for (i=0; i<6; i++ ) {
+    unsigned char line;
+    if (i == 5)
+      line = 0x0;
+    else
+      line = pgm_read_byte(font+(c*5)+i);
+    for ( j = 0; j<8; j++) {
+      if (line & 0x1) {
+        if (size == 1) // default size
+          drawPixel(x+i, y+j, color);
+        else {  // big size
+          fillRect(x+(i*size), y+(j*size), size, size, color);
+        }
+      } else if (bg != color) {
+        if (size == 1) // default size
+          drawPixel(x+i, y+j, bg);
+        else {  // big size
+          fillRect(x+i*size, y+j*size, size, size, bg);
+        }
+      }
+      line >>= 1;
+    }
+  }
+}
+
+
+inline void setCursor(short x, short y) {
+/* Set cursor for text to be printed
+ * Parameters:
+ *      x = x-coordinate of top-left of text starting
+ *      y = y-coordinate of top-left of text starting
+ * Returns: Nothing
+ */
+  cursor_x = x;
+  cursor_y = y;
+}
+
+inline void setTextSize(unsigned char s) {
+/*Set size of text to be displayed
+ * Parameters:
+ *      s = text size (1 being smallest)
+ * Returns: nothing
+ */
+  textsize = (s > 0) ? s : 1;
+}
+
+inline void setTextColor(char c) {
+  // For 'transparent' background, we'll set the bg
+  // to the same as fg instead of using a flag
+  textcolor = textbgcolor = c;
+}
+
+inline void setTextColor2(char c, char b) {
+/* Set color of text to be displayed
+ * Parameters:
+ *      c = 16-bit color of text
+ *      b = 16-bit color of text background
+ */
+  textcolor   = c;
+  textbgcolor = b;
+}
+
+inline void setTextWrap(char w) {
+  wrap = w;
+}
+
+
+// One character of a string laid out by l, at the cursor
+static void write_char(const text_layout *l, unsigned char c) {
+  if (c == '\n') {
+    cursor_y += textsize*8;
+    cursor_x  = 0;
+  } else if (c == '\r') {
+    // skip em
+  } else if (c == '\t'){
+      int new_x = cursor_x + tabspace;
+      if (new_x < _width){
+          cursor_x = new_x;
+      }
+  } else {
+    layout_char(l, cursor_x, cursor_y, c, textcolor, textbgcolor);
+    cursor_x += textsize*6;
+    if (wrap && (cursor_x > (_width - textsize*6))) {
+      cursor_y += textsize*8;
+      cursor_x = 0;
+    }
+  }
+}
+
+void tft_write(unsigned char c){
+  text_layout l ;
+  layout_text(&l, textsize) ;
+  write_char(&l, c) ;
+}
+
+inline void writeString(char* str){
+/* Print text onto screen
+ * Call tft_setCursor(), tft_setTextColor(), tft_setTextSize()
+ *  as necessary before printing
+ */
+    // Laid out once for the whole string
+    text_layout l ;
+    layout_text(&l, textsize) ;
+    while (*str){
+        write_char(&l, *str++);
+    }
+}
\ No newline at end of file
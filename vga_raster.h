@@ -0,0 +1,48 @@
+/**
+ * Framebuffer and draw targets shared by the VGA driver (vga_graphics.c),
+ * the drawing primitives (vga_raster.c) and the blit engine (vga_blit.c)
+ */
+
+#ifndef VGA_RASTER_H
+#define VGA_RASTER_H
+
+#include <stdbool.h>
+
+#define VGA_WIDTH  640
+#define VGA_HEIGHT 480
+
+// Framebuffer size: 2 pixels per byte
+#define VGA_BYTES (VGA_WIDTH * VGA_HEIGHT / 2)
+
+// The pixel color array streamed to the screen
+extern unsigned char vga_data_array[VGA_BYTES] ;
+
+// Where the drawing primitives write: a w x h pixel window whose top
+// left is screen pixel (x, y), packed 2 pixels/byte with rows w/2 bytes
+// apart. The whole screen, or the back buffer. x and w are even.
+// cx0..cx1, cy0..cy1 (exclusive) is the part of it inside the clip
+// rectangle (setClipRect), in the same coordinates as data.
+typedef struct {
+    unsigned char *data ;
+    short x, y, w, h ;
+    short cx0, cy0, cx1, cy1 ;
+} vga_target ;
+
+// The back buffer's window, and whether it waits to be copied to the
+// screen (set by flipBackBuffer, cleared by the vertical blanking
+// interrupt once it has been)
+extern vga_target vga_back_target ;
+extern volatile bool vga_flip_pending ;
+
+// The target the primitives draw on now (blits clip to it too)
+const vga_target *vga_draw_target(void) ;
+
+// Damage tracking (vga_damage.c): while vga_damage_enabled is set,
+// every primitive and blit passes its screen bounds to vga_damage_add
+extern bool vga_damage_enabled ;
+void vga_damage_add(int x, int y, int w, int h) ;
+
+// Set up the DMA blit engine (vga_blit.c; called by initVGA)
+void vga_blit_init(void) ;
+
+#endif
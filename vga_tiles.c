@@ -0,0 +1,152 @@
+/**
+ * Tile map and sprites, composed a scanline at a time (see vga_tiles.h)
+ *
+ * Memory only, like vga_raster.c: the line interrupt in vga_graphics.c
+ * calls vga_tiles_line, and so does the host build (host/vga_bench.c).
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+// Header file
+#include "vga_tiles.h"
+
+#define LINE_PIXELS 640
+#define LINE_BYTES  (LINE_PIXELS / 2)
+#define TILE_ROW_BYTES (VGA_TILE_SIZE / 2)
+
+// Bit masks for drawing a pixel into the odd or even half of a byte
+#define TOPMASK 0b11000111
+#define BOTTOMMASK 0b11111000
+
+// A position as one aligned word: stored and loaded in one access, so
+// the line interrupt never sees a new x with an old y
+typedef union {
+    struct { short x, y ; } ;
+    uint32_t word ;
+} position ;
+
+typedef struct {
+    position at ;
+    short w, h ;
+    const unsigned char *pixels ;       // NULL: hidden
+    char key ;
+} sprite ;
+
+static const unsigned char *tile_map ;
+static const unsigned char *tile_set ;
+static short map_w, map_h ;
+static bool tiles_aligned ;             // tile_set is word-aligned
+
+// Map pixel at the top left of the screen, inside the map
+static position scroll ;
+
+static sprite sprites[VGA_SPRITES] ;
+
+void setTileMap(const unsigned char *map, short w, short h, const unsigned char *tiles) {
+    // Black while it changes, as for sprites
+    tile_map = 0 ;
+    atomic_signal_fence(memory_order_seq_cst) ;
+    map_w = w ;
+    map_h = h ;
+    tile_set = tiles ;
+    tiles_aligned = ((uintptr_t)tiles & 3) == 0 ;
+    scrollTiles(scroll.x, scroll.y) ;
+    atomic_signal_fence(memory_order_seq_cst) ;
+    if (w > 0 && h > 0) tile_map = map ;
+}
+
+void scrollTiles(short x, short y) {
+    int width = map_w * VGA_TILE_SIZE, height = map_h * VGA_TILE_SIZE ;
+    if (width <= 0 || height <= 0) return ;
+    x %= width ;
+    y %= height ;
+    position p ;
+    p.x = (x < 0 ? x + width : x) & ~1 ;
+    p.y = y < 0 ? y + height : y ;
+    scroll.word = p.word ;
+}
+
+void setSprite(int id, short x, short y, short w, short h, const unsigned char *pixels, char key) {
+    sprite *s = &sprites[id] ;
+    // Hidden while it changes, so the line interrupt never sees half
+    s->pixels = 0 ;
+    atomic_signal_fence(memory_order_seq_cst) ;
+    s->at.x = x ;
+    s->at.y = y ;
+    s->w = w ;
+    s->h = h ;
+    s->key = key ;
+    atomic_signal_fence(memory_order_seq_cst) ;
+    s->pixels = pixels ;
+}
+
+void moveSprite(int id, short x, short y) {
+    position p ;
+    p.x = x ;
+    p.y = y ;
+    sprites[id].at.word = p.word ;
+}
+
+// One row of the tile map across the screen
+static void tiles_line(int y, unsigned char *line) {
+    position at = {.word = scroll.word} ;
+    // The map may be shorter than the screen: wrap as often as it takes
+    int map_y = (y + at.y) % (map_h * VGA_TILE_SIZE) ;
+    const unsigned char *map_row = &tile_map[(map_y / VGA_TILE_SIZE) * map_w] ;
+    const unsigned char *tiles = &tile_set[(map_y % VGA_TILE_SIZE) * TILE_ROW_BYTES] ;
+    int tx = at.x / VGA_TILE_SIZE ;
+    int skip = (at.x % VGA_TILE_SIZE) >> 1 ;
+
+    // Tile rows line up with words of the line: one load and store each
+    if (skip == 0 && tiles_aligned) {
+        uint32_t *dst = (uint32_t *)line ;
+        for (int i = 0; i < LINE_BYTES / TILE_ROW_BYTES; i++) {
+            dst[i] = *(const uint32_t *)&tiles[map_row[tx] * VGA_TILE_BYTES] ;
+            if (++tx == map_w) tx = 0 ;
+        }
+        return ;
+    }
+
+    // Otherwise byte by byte, starting part way into the first tile
+    unsigned char *dst = line ;
+    int left = LINE_BYTES ;
+    while (left > 0) {
+        const unsigned char *src = &tiles[map_row[tx] * VGA_TILE_BYTES + skip] ;
+        int n = TILE_ROW_BYTES - skip ;
+        if (n > left) n = left ;
+        left -= n ;
+        while (n--) *dst++ = *src++ ;
+        skip = 0 ;
+        if (++tx == map_w) tx = 0 ;
+    }
+}
+
+// The row of a sprite at `at` that crosses line y, skipping its key
+// color
+static void sprite_line(const sprite *s, position at, int y, unsigned char *line) {
+    const unsigned char *src = &s->pixels[(y - at.y) * ((s->w + 1) >> 1)] ;
+    int i0 = at.x < 0 ? -at.x : 0 ;
+    int i1 = at.x + s->w > LINE_PIXELS ? LINE_PIXELS - at.x : s->w ;
+    for (int i = i0; i < i1; i++) {
+        unsigned char color = (src[i >> 1] >> ((i & 1) * 3)) & 7 ;
+        if (color == s->key) continue ;
+        int x = at.x + i ;
+        unsigned char *d = &line[x >> 1] ;
+        if (x & 1) *d = (*d & TOPMASK) | (color << 3) ;
+        else *d = (*d & BOTTOMMASK) | color ;
+    }
+}
+
+void vga_tiles_line(int y, unsigned char *line) {
+    if (tile_map) tiles_line(y, line) ;
+    else memset(line, 0, LINE_BYTES) ;
+
+    for (int id = 0; id < VGA_SPRITES; id++) {
+        const sprite *s = &sprites[id] ;
+        if (!s->pixels) continue ;
+        position at = {.word = s->at.word} ;
+        if (y < at.y || y >= at.y + s->h) continue ;
+        sprite_line(s, at, y, line) ;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * Tile map and sprites, composed a scanline at a time (VGA_MODE_SCANLINE)
+ *
+ * In this mode the VGA driver keeps no framebuffer. DMA streams two
+ * 320-byte line buffers in turn, and the line interrupt (the hsync
+ * machine's irq 0) composes the next line into the one not being sent,
+ * from:
+ *
+ *  - a tile map: map_w x map_h bytes, each the index of an 8x8 tile in
+ *    the tile set, scrolled by any amount and wrapping at its edges
+ *  - up to VGA_SPRITES sprites over it, higher ids on top, with pixels
+ *    of the sprite's key color left transparent
+ *
+ * Tiles and sprites are packed like the framebuffer: two pixels per
+ * byte, the even pixel in bits 0-2. A tile is VGA_TILE_BYTES bytes, 4
+ * per row; a sprite row is (w + 1) / 2 bytes.
+ *
+ * A line has to be composed in under one active line (25 us, about
+ * 3200 cycles at 125 MHz). With the horizontal scroll a multiple of 8
+ * and a word-aligned tile set the tiles are 80 word copies; sprites
+ * cost a few cycles per pixel on the lines they cross. Keep the map,
+ * tiles and sprite pixels in RAM: a flash cache miss in the line
+ * interrupt costs more than the line.
+ *
+ * Changes show from the next line composed. For a whole frame at once,
+ * make them right after waitForVBlank() (the first 8 pixels of the top
+ * line are fetched before it returns).
+ *
+ * Call the functions below from the core that takes the line interrupt
+ * (the one that called initVGA). They are safe against that interrupt
+ * only: scrollTiles and moveSprite store the position in one word, and
+ * setTileMap and setSprite hide what they change until it is whole,
+ * ordered with compiler fences, which order nothing for the other core.
+ *
+ * The drawing primitives in vga_graphics.h need the framebuffer: they
+ * are not built in this mode.
+ */
+
+#ifndef VGA_TILES_H
+#define VGA_TILES_H
+
+#include <stdbool.h>
+
+// Tile size in pixels (square) and bytes
+#define VGA_TILE_SIZE  8
+#define VGA_TILE_BYTES 32
+
+// Sprites composed over the tiles
+#ifndef VGA_SPRITES
+#define VGA_SPRITES 16
+#endif
+
+// Show a tile map (map_w x map_h tile indices, row by row) drawn from a
+// tile set. NULL map: black.
+void setTileMap(const unsigned char *map, short map_w, short map_h, const unsigned char *tiles) ;
+
+// Map pixel at the top left of the screen. x is rounded to even.
+void scrollTiles(short x, short y) ;
+
+// Show sprite id (0 to VGA_SPRITES - 1) at (x, y), or hide it if
+// pixels is NULL. Sprites may hang off any edge of the screen.
+void setSprite(int id, short x, short y, short w, short h, const unsigned char *pixels, char key) ;
+void moveSprite(int id, short x, short y) ;
+
+// Block until the last line of the frame has started (vga_graphics.c)
+void waitForVBlank(void) ;
+
+// Compose screen line y (0-479) into line, 320 bytes (the line
+// interrupt; host/vga_bench.c calls it directly)
+void vga_tiles_line(int y, unsigned char *line) ;
+
+#endif
@@ -0,0 +1,42 @@
+# Kaiser-windowed sinc lowpass, shared by the generators: the resampler's
+# prototype filters (gen_resampler_table.py) and the asset packer's rate
+# conversion (gen_audio_assets.py).
+#
+# A filter has `width` input samples per wing and a stopband attenuation
+# in dB. Its transition band ends at the Nyquist rate, so nothing above
+# it aliases back by more than the attenuation allows.
+
+import math
+
+
+def bessel_i0(x):
+    term, total, k = 1.0, 1.0, 1
+    while term > 1e-12 * total:
+        term *= (x / (2 * k)) ** 2
+        total += term
+        k += 1
+    return total
+
+
+def kaiser_beta(atten):
+    if atten > 50:
+        return 0.1102 * (atten - 8.7)
+    return 0.5842 * (atten - 21) ** 0.4 + 0.07886 * (atten - 21)
+
+
+def design(width, atten):
+    """Cutoff (fraction of the Nyquist rate) and Kaiser beta"""
+    # Kaiser transition width for a 2*width tap filter, as a fraction of
+    # the Nyquist rate; centre the cutoff so the band ends at Nyquist
+    transition = (atten - 7.95) / (14.36 * width)
+    return 1.0 - transition / 2, kaiser_beta(atten)
+
+
+def kernel(t, width, fc, beta):
+    """h(t) = fc * sinc(fc * t) * kaiser(t / width), t in input samples"""
+    r = t / width
+    if abs(r) >= 1:
+        return 0.0
+    x = fc * t
+    sinc = 1.0 if x == 0 else math.sin(math.pi * x) / (math.pi * x)
+    return fc * sinc * bessel_i0(beta * math.sqrt(1 - r * r)) / bessel_i0(beta)